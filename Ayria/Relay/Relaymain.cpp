@@ -0,0 +1,47 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+*/
+
+#include <Global.hpp>
+
+// Headless entrypoint, clients connect to us and we keep and forward the Messagestream.
+int main()
+{
+    // Ensure that Ayrias default directories exist.
+    std::filesystem::create_directories("./Ayria/Logs");
+    std::filesystem::create_directories("./Ayria/Storage");
+
+    // Only keep a log for this session.
+    Logging::Clearlog();
+
+    #if !defined(_WIN32)
+    // Dead nodes are noticed when send() fails, not by signal.
+    signal(SIGPIPE, SIG_IGN);
+
+    // Every client is a socket, so raise the limit as far as we are allowed.
+    rlimit Limit{};
+    if (0 == getrlimit(RLIMIT_NOFILE, &Limit))
+    {
+        Limit.rlim_cur = Limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &Limit);
+    }
+    #endif
+
+    Backend::Initialize();
+
+    // The console is our only interface, commands are read from stdin.
+    char Buffer[1024]{};
+    while (std::fgets(Buffer, sizeof(Buffer), stdin))
+    {
+        auto Commandline = std::string_view(Buffer);
+        while (!Commandline.empty() && (Commandline.back() == '\n' || Commandline.back() == '\r'))
+            Commandline.remove_suffix(1);
+
+        if (!Commandline.empty()) Console::execCommand(Commandline);
+    }
+
+    // No stdin when running as a service, so just keep serving.
+    while (true) std::this_thread::sleep_for(std::chrono::hours(1));
+}
@@ -16,6 +16,9 @@ namespace Backend
     Hashset<int64_t> getModified(const std::string &Tablename);
     sqlite::database Database();
 
+    // Held for the duration of any explicit transaction on the shared connection, so that nobody joins a transaction they do not own.
+    std::recursive_mutex &Transactionlock();
+
     // Set the global cryptokey from various sources.
     void setCryptokey_CRED(std::string_view Cred1, std::string_view Cred2);
     void setCryptokey_TEMP();
@@ -28,12 +31,15 @@ namespace Backend
 // Layer 1 - Networking between clients.
 namespace Backend::Messagebus
 {
-    // General N<->N networking, big endian.
+    // General N<->N networking, host order.
     void Connectuser(uint32_t IPv4, uint16_t Port);
     void Publish(std::string_view Identifier, std::string_view Payload);
 
-    // Set up the networking and connect to others.
-    void Initialize(bool doLANDiscovery = true);
+    // Fetch what we missed while offline, each relay serves a slice of the time.
+    void Catchup(std::vector<std::pair<uint32_t, uint16_t>> Relays);
+
+    // Set up the networking and connect to others, Port = 0 for a random one.
+    void Initialize(bool doLANDiscovery = true, uint16_t Port = 0);
 }
 namespace Layer1 = Backend::Messagebus;
 
@@ -43,8 +49,32 @@ namespace Backend::Messageprocessing
     typedef bool (__cdecl *Callback_t)(uint64_t Timestamp, const char *LongID, const char *Message, unsigned int Length);
     // static bool __cdecl Handler(uint64_t Timestamp, const char *LongID, const char *Message, unsigned int Length);
 
-    // Listen for packets of a certain type.
-    void addMessagehandler(std::string_view Identifier, Callback_t Handler);
+    // Listen for packets of a certain type, order is only kept per sender as senders are processed in parallel.
+    // Handlers touching state shared between senders (e.g. caches) need to be serialized with isShared.
+    void addMessagehandler(std::string_view Identifier, Callback_t Handler, bool isShared = false);
+
+    // Internal handlers get the message parsed once and shared between all handlers of the type.
+    using Parsedcallback_t = bool (__cdecl *)(uint64_t Timestamp, const char *LongID, const JSON::Value_t &Message);
+    // static bool __cdecl Handler(uint64_t Timestamp, const char *LongID, const JSON::Value_t &Message);
+    void addMessagehandler(std::string_view Identifier, Parsedcallback_t Handler, bool isShared = false);
+
+    // Layer 1 hands over newly stored messages directly, the Messagestream is only read back for recovery.
+    // Received is the local time of arrival for the lag statistics, unset for recovered messages.
+    using Message_t = struct { std::string Sender; uint32_t Messagetype; uint64_t Timestamp; std::string Signature, Message; std::chrono::steady_clock::time_point Received{}; };
+    void Enqueue(std::vector<Message_t> &&Messages);
+
+    // Cached per thread for handlers, bind and execute() as the binder will not run on destruction.
+    sqlite::database_binder &getStatement(std::string_view SQL);
+
+    // Last-writer-wins types only need the newest message per (Sender, Key), older ones get compacted.
+    using Compactionkey_t = std::string (__cdecl *)(const char *Message, unsigned int Length);
+    void addCompactionpolicy(std::string_view Identifier, Compactionkey_t Keyfunction = nullptr);
+
+    // Tables only written by handlers, truncated and replayed from the Messagestream on rebuild.
+    void addDerivedtable(std::string_view Tablename);
+
+    // Handlers should leave everything but their tables alone (e.g. caches) while the stream is replayed.
+    bool isRebuilding();
 
     // Set up the system.
     void Initialize();
@@ -59,9 +89,36 @@ namespace Backend::JSONAPI
 
     // Listen for requests to this functionname.
     void addEndpoint(std::string_view Functionname, Callback_t Callback);
+
+    // Read-only endpoints, results are reused until one of the tables changes.
+    void addEndpoint(std::string_view Functionname, Callback_t Callback, std::initializer_list<std::string_view> Tables);
+
+    // For internal use by the update-hook, and for changes it does not see (e.g. truncation).
+    void Invalidate(std::string_view Tablename);
+
+    // For internal use by the commit and rollback hooks.
+    void onTransactionend();
+
+    // For internal use, the result is valid for 16 calls on the same thread.
+    const char *callEndpoint(std::string_view Functionname, JSON::Value_t &&Request);
 }
 namespace Layer3 = Backend::JSONAPI;
 
+// Typed binary calls for fixed-shape hot paths, arguments and results are Bytebuffer encoded.
+namespace Backend::BinaryAPI
+{
+    using Schema_t = std::vector<std::pair<std::string, Bytebuffertype>>;
+    using Callback_t = bool (__cdecl *)(Bytebuffer &Arguments, Bytebuffer &Result);
+    // static bool __cdecl Callback(Bytebuffer &Arguments, Bytebuffer &Result);
+
+    // Keyed by Hash::WW32(Functionname), arguments are checked against the schema before the call.
+    void addEndpoint(std::string_view Functionname, Schema_t &&Arguments, Callback_t Callback);
+    bool callEndpoint(uint32_t FunctionID, Bytebuffer &Arguments, Bytebuffer &Result);
+
+    // C header with the IDs and argument encoders for all registered endpoints.
+    std::string Generateheader();
+}
+
 // Layer 4 - Check database changes and notify the user.
 namespace Backend::Notifications
 {
@@ -71,6 +128,10 @@ namespace Backend::Notifications
     void Publish(std::string_view Identifier, const char *JSONString);
     void Unsubscribe(std::string_view Identifier, Callback_t Handler);
 
+    // Internal, message handlers run inside the batch transaction so their notifications are held until it's done.
+    void Defer(bool Enable);
+    void Flushdeferred(bool Discard = false);
+
     // Internal.
     // static void __cdecl Callback(int64_t RowID);
     using Processor_t = void(__cdecl *)(int64_t RowID);
@@ -5,8 +5,11 @@
 */
 
 #include "AABackend.hpp"
+
+#if defined(_WIN32)
 #include <openssl/curve25519.h>
 #include <winioctl.h>
+#endif
 
 // 512-bit aligned storage.
 Globalstate_t Global{};
@@ -27,7 +30,7 @@ namespace Backend
         std::scoped_lock _(Threadsafe);
         Backgroundtasks.push_back({ 0, PeriodMS, Callback });
     }
-    [[noreturn]] static DWORD __stdcall Backgroundthread(void *)
+    [[noreturn]] static void Backgroundthread()
     {
         // Name this thread for easier debugging.
         setThreadname("Ayria_Background");
@@ -97,6 +100,9 @@ namespace Backend
     }
     static void UpdateCB(void *, int Type, const char *, const char *Table, int64_t RowID)
     {
+        // Any change makes cached results stale, deletions included.
+        JSONAPI::Invalidate(Table);
+
         // We don't care about deletions..
         if (Type == SQLITE_INSERT || Type == SQLITE_UPDATE) [[likely]]
         {
@@ -111,6 +117,64 @@ namespace Backend
         }
     }
 
+    // Cached results may be used again once the changes are committed, or rolled back.
+    static int CommitCB(void *)
+    {
+        JSONAPI::onTransactionend();
+        return 0;
+    }
+    static void RollbackCB(void *)
+    {
+        JSONAPI::onTransactionend();
+    }
+
+    // Convert the Base85 TEXT columns of older databases to BLOBs.
+    static void MigrateMessagestream(const std::shared_ptr<sqlite3> &Database)
+    {
+        sqlite::database DB(Database);
+
+        // Base85Decode(Text, Trimpadding), the padding of the old messages decoded to trailing nulls.
+        const auto Lambda85 = [](sqlite3_context *context, int argc, sqlite3_value **argv) -> void
+        {
+            if (argc != 2) return;
+            if (SQLITE3_TEXT != sqlite3_value_type(argv[0])) { sqlite3_result_null(context); return; }
+
+            // SQLite may invalidate the pointer if _bytes is called after text.
+            const auto Length = sqlite3_value_bytes(argv[0]);
+            auto Decoded = Base85::Decode(std::string_view((const char *)sqlite3_value_text(argv[0]), Length));
+            if (sqlite3_value_int(argv[1])) while (!Decoded.empty() && Decoded.back() == '\0') Decoded.pop_back();
+
+            sqlite3_result_blob(context, Decoded.data(), int(Decoded.size()), SQLITE_TRANSIENT);
+        };
+        sqlite3_create_function(Database.get(), "Base85Decode", 2, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, Lambda85, nullptr, nullptr);
+
+        try
+        {
+            DB << "BEGIN TRANSACTION;";
+            DB << "ALTER TABLE Messagestream RENAME TO Messagestream_Base85;";
+            DB <<
+                "CREATE TABLE Messagestream ("
+                "Sender TEXT REFERENCES Account (Publickey) ON DELETE CASCADE, "
+                "Messagetype INTEGER NOT NULL, "
+                "Timestamp INTEGER NOT NULL, "
+                "Signature BLOB NOT NULL, "
+                "Message BLOB NOT NULL, "
+                "isProcessed BOOLEAN, "
+                "UNIQUE (Sender, Signature) );";
+            DB << "INSERT OR IGNORE INTO Messagestream SELECT Sender, Messagetype, Timestamp, "
+                  "Base85Decode(Signature, 0), Base85Decode(Message, 1), isProcessed FROM Messagestream_Base85;";
+            DB << "DROP TABLE Messagestream_Base85;";
+            DB << "COMMIT;";
+        }
+        catch (const sqlite::sqlite_exception &e)
+        {
+            (void)e; Debugprint(va("Messagestream migration failed: %s", e.what()));
+            try { DB << "ROLLBACK;"; } catch (...) {}
+        }
+
+        sqlite3_create_function(Database.get(), "Base85Decode", 2, SQLITE_UTF8, nullptr, nullptr, nullptr, nullptr);
+    }
+
     // Interface with the client database, remember try-catch.
     sqlite::database Database()
     {
@@ -127,6 +191,8 @@ namespace Backend
             // Intercept updates from plugins writing to the DB.
             if constexpr (Build::isDebug) sqlite3_db_config(Ptr, SQLITE_CONFIG_LOG, SQLErrorlog, "Client.sqlite");
             sqlite3_update_hook(Ptr, UpdateCB, nullptr);
+            sqlite3_commit_hook(Ptr, CommitCB, nullptr);
+            sqlite3_rollback_hook(Ptr, RollbackCB, nullptr);
             sqlite3_extended_result_codes(Ptr, false);
 
             // Close the DB at exit to ensure everything's flushed.
@@ -167,15 +233,22 @@ namespace Backend
                     "CREATE TABLE IF NOT EXISTS Account ("
                     "Publickey TEXT NOT NULL PRIMARY KEY );";
 
+                // Older versions stored the binary data as Base85 TEXT.
+                std::string Messageformat{};
+                sqlite::database(Database) << "SELECT type FROM pragma_table_info('Messagestream') WHERE name = 'Message';"
+                                           >> [&](const std::string &Type) { Messageformat = Type; };
+
                 sqlite::database(Database) <<
                     "CREATE TABLE IF NOT EXISTS Messagestream ("
                     "Sender TEXT REFERENCES Account (Publickey) ON DELETE CASCADE, "
                     "Messagetype INTEGER NOT NULL, "
                     "Timestamp INTEGER NOT NULL, "
-                    "Signature TEXT NOT NULL, "
-                    "Message TEXT NOT NULL, "
+                    "Signature BLOB NOT NULL, "
+                    "Message BLOB NOT NULL, "
                     "isProcessed BOOLEAN, "
                     "UNIQUE (Sender, Signature) );";
+
+                if (Messageformat == "TEXT") [[unlikely]] MigrateMessagestream(Database);
             } catch (...) {}
 
             // Perform cleanup on exit.
@@ -197,6 +270,14 @@ namespace Backend
         return sqlite::database(Database);
     }
 
+    // Held for the duration of any explicit transaction on the shared connection, so that nobody joins a transaction they do not own.
+    // Recursive as handlers publish from inside of the Layer 2 batch.
+    std::recursive_mutex &Transactionlock()
+    {
+        static std::recursive_mutex Lock{};
+        return Lock;
+    }
+
     // Save the configuration to disk.
     static void Saveconfig()
     {
@@ -204,6 +285,8 @@ namespace Backend
         Object["enableExternalconsole"] = Global.Settings.enableExternalconsole;
         Object["enableIATHooking"] = Global.Settings.enableIATHooking;
         Object["enableFileshare"] = Global.Settings.enableFileshare;
+        Object["enableBatching"] = Global.Settings.enableBatching;
+        Object["enableGossip"] = Global.Settings.enableGossip;
         Object["Username"] = *Global.Username;
 
         FS::Writefile(L"./Ayria/Settings.json", JSON::Dump(Object));
@@ -214,9 +297,14 @@ namespace Backend
     {
         // Load the last configuration from disk.
         const auto Config = JSON::Parse(FS::Readfile<char>(L"./Ayria/Settings.json"));
+        #if defined(AYRIA_RELAY)
+        const auto Relayport = Config.value("Relayport", uint16_t(14986));
+        #endif
         Global.Settings.enableExternalconsole = Config.value<bool>("enableExternalconsole");
         Global.Settings.enableIATHooking = Config.value<bool>("enableIATHooking");
         Global.Settings.enableFileshare = Config.value<bool>("enableFileshare");
+        Global.Settings.enableBatching = Config.value<bool>("enableBatching");
+        Global.Settings.enableGossip = Config.value<bool>("enableGossip");
         *Global.Username = Config.value("Username", u8"AYRIA"s);
 
         // Select a source for crypto, credentials are used from the GUI.
@@ -237,18 +325,40 @@ namespace Backend
         _mm_setcsr(_mm_getcsr() | 0x8040); // _MM_FLUSH_ZERO_ON | _MM_DENORMALS_ZERO_ON
 
         // As of Windows 10 update 20H2 (v2004) we need to set the interrupt resolution for each process.
+        #if defined(_WIN32)
         timeBeginPeriod(1);
+        #endif
 
-        // Initialize subsystems that plugins may need.
-        Messagebus::Initialize();
+        // Initialize subsystems that plugins may need, relays listen on a known port and have no plugins.
         Messageprocessing::Initialize();
+        #if defined(AYRIA_RELAY)
+        Messagebus::Initialize(false, Relayport);
+        #else
+        Messagebus::Initialize();
+        #endif
         Notifications::Initialize();
         Services::Initialize();
         Console::Initialize();
+
+        // Relays are listed as "IPv4:Port".
+        std::vector<std::pair<uint32_t, uint16_t>> Relays{};
+        for (const auto &Relay : Config.value<JSON::Array_t>("Relays"))
+        {
+            const auto Address = Relay.get<std::string>();
+            const auto Split = Address.find(':');
+            if (Split == std::string::npos) continue;
+
+            const auto IPv4 = inet_addr(Address.substr(0, Split).c_str());
+            const auto Port = std::atoi(Address.c_str() + Split + 1);
+            if (IPv4 != INADDR_NONE && Port > 0 && Port <= 0xFFFF) Relays.emplace_back(ntohl(IPv4), uint16_t(Port));
+        }
+        Messagebus::Catchup(std::move(Relays));
+        #if !defined(AYRIA_RELAY)
         Plugins::Initialize();
+        #endif
 
         // Create a worker-thread in the background.
-        CreateThread(NULL, NULL, Backgroundthread, NULL, STACK_SIZE_PARAM_IS_A_RESERVATION, NULL);
+        std::thread(Backgroundthread).detach();
     }
 
     // Export functionality to the plugins.
@@ -317,7 +427,11 @@ inline std::pair<std::string, std::string> GenerateHWID()
 
     return { MOBOSerial, SystemUUID };
     #else
-    static_assert(false, "NIX function is not yet implemented.");
-    return {};
+    // The board serial needs root, so use the ID generated at install time instead.
+    auto MachineID = FS::Readfile<char>("/etc/machine-id");
+    auto ProductUUID = FS::Readfile<char>("/sys/class/dmi/id/product_uuid");
+    std::erase(MachineID, '\n'); std::erase(ProductUUID, '\n');
+
+    return { MachineID, ProductUUID };
     #endif
 }
@@ -0,0 +1,190 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+*/
+
+#include <Global.hpp>
+
+namespace Backend::BinaryAPI
+{
+    using Endpoint_t = struct { std::string Functionname; Schema_t Arguments; Callback_t Callback; };
+    static Hashmap<uint32_t, Endpoint_t> Requesthandlers{};
+
+    // Keyed by Hash::WW32(Functionname), arguments are checked against the schema before the call.
+    void addEndpoint(std::string_view Functionname, Schema_t &&Arguments, Callback_t Callback)
+    {
+        if (Callback) Requesthandlers[Hash::WW32(Functionname)] = { std::string(Functionname), std::move(Arguments), Callback };
+    }
+
+    // Reads every declared argument once, so handlers can read without checking each value.
+    template <typename T> static bool Skip(Bytebuffer &Buffer) { T Value{}; return Buffer.Read(Value); }
+    static bool Validate(Bytebuffer &Arguments, const Schema_t &Schema)
+    {
+        bool isValid = true;
+        for (const auto &Type : Schema | std::views::values)
+        {
+            switch (Type)
+            {
+                case BB_BOOL: isValid = Skip<bool>(Arguments); break;
+                case BB_SINT8: isValid = Skip<int8_t>(Arguments); break;
+                case BB_UINT8: isValid = Skip<uint8_t>(Arguments); break;
+                case BB_WCHAR: isValid = Skip<wchar_t>(Arguments); break;
+                case BB_SINT16: isValid = Skip<int16_t>(Arguments); break;
+                case BB_UINT16: isValid = Skip<uint16_t>(Arguments); break;
+                case BB_SINT32: isValid = Skip<int32_t>(Arguments); break;
+                case BB_UINT32: isValid = Skip<uint32_t>(Arguments); break;
+                case BB_SINT64: isValid = Skip<int64_t>(Arguments); break;
+                case BB_UINT64: isValid = Skip<uint64_t>(Arguments); break;
+                case BB_FLOAT32: isValid = Skip<float>(Arguments); break;
+                case BB_FLOAT64: isValid = Skip<double>(Arguments); break;
+                case BB_ASCIISTRING: isValid = Skip<std::string>(Arguments); break;
+                case BB_UNICODESTRING: isValid = Skip<std::wstring>(Arguments); break;
+                case BB_BLOB: isValid = Skip<Blob>(Arguments); break;
+                default: isValid = false; break;
+            }
+
+            if (!isValid) break;
+        }
+
+        Arguments.Internaliterator = 0;
+        return isValid;
+    }
+
+    // For internal use.
+    bool callEndpoint(uint32_t FunctionID, Bytebuffer &Arguments, Bytebuffer &Result)
+    {
+        const auto Handler = Requesthandlers.find(FunctionID);
+        if (Handler == Requesthandlers.end()) [[unlikely]] return false;
+        if (!Validate(Arguments, Handler->second.Arguments)) [[unlikely]] return false;
+
+        return Handler->second.Callback(Arguments, Result);
+    }
+
+    // C header with the IDs and argument encoders for all registered endpoints.
+    std::string Generateheader()
+    {
+        // C parameter type (spaced for the name), how to compute the size for strings, and the name of the type-tag.
+        using Ctype_t = struct { std::string_view Ctype, Sizeformat, Tagname; };
+        static const Hashmap<uint8_t, Ctype_t> Ctypes
+        {
+            { BB_BOOL, { "bool ", "", "BOOL" } }, { BB_WCHAR, { "wchar_t ", "", "WCHAR" } },
+            { BB_SINT8, { "int8_t ", "", "SINT8" } }, { BB_UINT8, { "uint8_t ", "", "UINT8" } },
+            { BB_SINT16, { "int16_t ", "", "SINT16" } }, { BB_UINT16, { "uint16_t ", "", "UINT16" } },
+            { BB_SINT32, { "int32_t ", "", "SINT32" } }, { BB_UINT32, { "uint32_t ", "", "UINT32" } },
+            { BB_SINT64, { "int64_t ", "", "SINT64" } }, { BB_UINT64, { "uint64_t ", "", "UINT64" } },
+            { BB_FLOAT32, { "float ", "", "FLOAT32" } }, { BB_FLOAT64, { "double ", "", "FLOAT64" } },
+            { BB_ASCIISTRING, { "const char *", "(unsigned int)strlen(%s) + 1", "ASCIISTRING" } },
+            { BB_UNICODESTRING, { "const wchar_t *", "(unsigned int)((wcslen(%s) + 1) * sizeof(wchar_t))", "UNICODESTRING" } },
+            { BB_BLOB, { "const uint8_t *", "", "BLOB" } }
+        };
+
+        std::string Header =
+            "/*\n"
+            "    Generated by Ayria from the registered binary endpoints, do not edit.\n"
+            "    Encoders return the size written, pass NULL as the buffer to get the size needed.\n"
+            "    Results use the same encoding and are valid until the next BinaryRequest on the thread.\n"
+            "*/\n\n"
+            "#pragma once\n"
+            "#include <stdint.h>\n"
+            "#include <stdbool.h>\n"
+            "#include <string.h>\n"
+            "#include <wchar.h>\n\n"
+            "// The exports use the platform default convention, which is only spelled out for MSVC.\n"
+            "#if defined(_MSC_VER)\n"
+            "#define AYA_CALL __cdecl\n"
+            "#else\n"
+            "#define AYA_CALL\n"
+            "#endif\n\n";
+
+        // Emitted from the Bytebuffer enum, so the header can't drift from the encoding.
+        for (uint8_t Type = BB_BOOL; Type <= BB_BLOB; ++Type)
+        {
+            const auto &Tagname = Ctypes.at(Type).Tagname;
+            Header.append(va("#define AYA_TYPE_%.*s %u\n", int(Tagname.size()), Tagname.data(), Type));
+        }
+
+        Header.append(
+            "\ntypedef const void *(AYA_CALL *AYA_BinaryRequest_t)(unsigned int FunctionID, const void *Arguments, unsigned int Length, unsigned int *Resultlength);\n\n"
+            "static inline unsigned int AYA_Writeraw(uint8_t *Buffer, unsigned int Offset, const void *Data, unsigned int Size)\n"
+            "{\n"
+            "    if (Buffer && Size) memcpy(Buffer + Offset, Data, Size);\n"
+            "    return Offset + Size;\n"
+            "}\n"
+            "static inline unsigned int AYA_Writetyped(uint8_t *Buffer, unsigned int Offset, uint8_t Type, const void *Data, unsigned int Size)\n"
+            "{\n"
+            "    return AYA_Writeraw(Buffer, AYA_Writeraw(Buffer, Offset, &Type, 1), Data, Size);\n"
+            "}\n"
+            "static inline unsigned int AYA_Writeblob(uint8_t *Buffer, unsigned int Offset, const uint8_t *Data, uint32_t Size)\n"
+            "{\n"
+            "    const uint8_t Type = AYA_TYPE_BLOB;\n"
+            "    Offset = AYA_Writeraw(Buffer, Offset, &Type, 1);\n"
+            "    Offset = AYA_Writetyped(Buffer, Offset, AYA_TYPE_UINT32, &Size, sizeof(Size));\n"
+            "    return AYA_Writeraw(Buffer, Offset, Data, Size);\n"
+            "}\n");
+
+        // Sorted by name, so that the header only changes when the endpoints do.
+        std::vector<std::pair<uint32_t, const Endpoint_t *>> Sorted{};
+        for (const auto &[ID, Endpoint] : Requesthandlers) Sorted.emplace_back(ID, &Endpoint);
+        std::ranges::sort(Sorted, std::less{}, [](const auto &Item) -> const std::string & { return Item.second->Functionname; });
+
+        for (const auto &[ID, Endpoint] : Sorted)
+        {
+            const auto &Functionname = Endpoint->Functionname;
+
+            // Client::setGamestate -> Client_setGamestate
+            std::string Identifier{};
+            for (size_t i = 0; i < Functionname.size(); ++i)
+            {
+                if (Functionname[i] == ':' && i + 1 < Functionname.size() && Functionname[i + 1] == ':') continue;
+                const auto Char = Functionname[i];
+                const auto isAlnum = (Char >= '0' && Char <= '9') || (Char >= 'a' && Char <= 'z') || (Char >= 'A' && Char <= 'Z');
+                Identifier.push_back(isAlnum ? Char : '_');
+            }
+
+            std::string Parameters{}, Body{};
+            for (const auto &[Name, Type] : Endpoint->Arguments)
+            {
+                const auto &[Ctype, Sizeformat, Tagname] = Ctypes.at(Type);
+                Parameters.append(va(", %.*s%s", int(Ctype.size()), Ctype.data(), Name.c_str()));
+
+                if (Type == BB_BLOB)
+                {
+                    Parameters.append(va(", uint32_t %sLength", Name.c_str()));
+                    Body.append(va("    Offset = AYA_Writeblob(Buffer, Offset, %s, %sLength);\n", Name.c_str(), Name.c_str()));
+                }
+                else if (!Sizeformat.empty())
+                {
+                    const auto Size = va(std::string(Sizeformat).c_str(), Name.c_str());
+                    Body.append(va("    Offset = AYA_Writetyped(Buffer, Offset, AYA_TYPE_%.*s, %s, %s);\n", int(Tagname.size()), Tagname.data(), Name.c_str(), Size.c_str()));
+                }
+                else
+                {
+                    Body.append(va("    Offset = AYA_Writetyped(Buffer, Offset, AYA_TYPE_%.*s, &%s, sizeof(%s));\n", int(Tagname.size()), Tagname.data(), Name.c_str(), Name.c_str()));
+                }
+            }
+
+            Header.append(va("\n// %s\n", Functionname.c_str()));
+            Header.append(va("#define AYA_ID_%s 0x%08XU\n", Identifier.c_str(), ID));
+            Header.append(va("static inline unsigned int AYA_Encode_%s(uint8_t *Buffer%s)\n{\n", Identifier.c_str(), Parameters.c_str()));
+            Header.append("    unsigned int Offset = 0;\n");
+            Header.append(Body);
+            Header.append("    return Offset;\n}\n");
+        }
+
+        return Header;
+    }
+
+    // Access from the plugins, the result is valid until the next call on this thread.
+    extern "C" EXPORT_ATTR const void *__cdecl BinaryRequest(unsigned int FunctionID, const void *Arguments, unsigned int Length, unsigned int *Resultlength)
+    {
+        thread_local Bytebuffer Result{};
+        Result = Bytebuffer{};
+
+        Bytebuffer Request = Arguments ? Bytebuffer(Arguments, Length) : Bytebuffer{};
+        const auto isValid = callEndpoint(FunctionID, Request, Result);
+
+        if (Resultlength) *Resultlength = isValid ? static_cast<uint32_t>(Result.Internalsize) : 0;
+        return isValid ? (Result.Internalsize ? Result.Internalbuffer.get() : (const void *)"") : nullptr;
+    }
+}
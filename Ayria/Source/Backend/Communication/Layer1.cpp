@@ -5,16 +5,27 @@
 */
 
 #include <Global.hpp>
+#include "Messagebus.hpp"
 
 // Big endian.
 static uint16_t Listenport;
 
+// in_addr is a union on Windows, so go through the s_addr name that both platforms share. Big endian.
+static sockaddr_in Makeaddress(uint32_t IPv4, uint16_t Port)
+{
+    sockaddr_in Address{};
+    Address.sin_family = AF_INET;
+    Address.sin_port = Port;
+    Address.sin_addr.s_addr = IPv4;
+    return Address;
+}
+
 namespace LANDiscovery
 {
     constexpr uint32_t Discoveryaddress = Hash::FNV1_32("Ayria") << 8;   // 228.58.137.0
     constexpr uint16_t Discoveryport = Hash::FNV1_32("Ayria") & 0xFFFF;  // 14985
 
-    static const sockaddr_in Multicast{ AF_INET, htons(Discoveryport), {{.S_addr = htonl(Discoveryaddress)}} };
+    static const sockaddr_in Multicast = Makeaddress(htonl(Discoveryaddress), htons(Discoveryport));
     static size_t Discoverysocket{};
     static uint32_t RandomID{};
 
@@ -32,39 +43,31 @@ namespace LANDiscovery
             Tickcount = 0;
         }
 
-        // Check for data on the socket.
-        FD_SET ReadFD{}; FD_SET(Discoverysocket, &ReadFD);
-        constexpr timeval Defaulttimeout{ NULL, 1 };
-        const auto Count{ ReadFD.fd_count };
-        auto Timeout{ Defaulttimeout };
-
-        if (!select(Count, &ReadFD, nullptr, nullptr, &Timeout)) [[likely]]
-            return;
-
+        // The socket is non-blocking, so just read until it's empty.
         while (true)
         {
             char Buffer[6]{};
 
-            sockaddr_in Clientinfo{}; int Len = sizeof(Clientinfo);
+            sockaddr_in Clientinfo{}; socklen_t Len = sizeof(Clientinfo);
             const auto Data = recvfrom(Discoverysocket, Buffer, 6, NULL, PSOCKADDR(&Clientinfo), &Len);
             if (Data < 6) [[unlikely]] break;   // Also covers any errors.
 
             // We also receive our own requests, but we can use it for IP discovery.
             if (RandomID == *(uint32_t *)&Buffer[0]) [[likely]]
             {
-                Global.InternalIP = Clientinfo.sin_addr.S_un.S_addr;
+                Global.InternalIP = Clientinfo.sin_addr.s_addr;
                 continue;
             }
 
             // Try to connect to this client if we haven't already.
-            Backend::Messagebus::Connectuser(ntohl(Clientinfo.sin_addr.S_un.S_addr), ntohs(*(uint16_t *)&Buffer[4]));
+            Backend::Messagebus::Connectuser(ntohl(Clientinfo.sin_addr.s_addr), ntohs(*(uint16_t *)&Buffer[4]));
         }
     }
 
     void Initialize()
     {
-        const sockaddr_in Localhost{ AF_INET, htons(Discoveryport), {{.S_addr = htonl(INADDR_ANY)}} };
-        const ip_mreq Request{ {{.S_addr = htonl(Discoveryaddress)}} };
+        const sockaddr_in Localhost = Makeaddress(htonl(INADDR_ANY), htons(Discoveryport));
+        ip_mreq Request{}; Request.imr_multiaddr.s_addr = htonl(Discoveryaddress);
         unsigned long Argument{ 1 };
         unsigned long Error{ 0 };
         WSADATA Unused;
@@ -109,20 +112,465 @@ namespace Backend::Messagebus
     };
     struct Packet_t
     {
+        std::array<uint8_t, 32> Sender;
         std::array<uint8_t, 64> Signature;
+        uint8_t Hops;
         Payload_t Payload;
     };
     #pragma pack(pop)
 
-    using Node_t = struct { uint32_t IPv4; uint16_t Port; size_t Socket; };
-    static Hashmap<std::string, Node_t> Connectednodes;
+    // Frames are prefixed by their size, big endian.
+    using Framesize_t = uint16_t;
+
+    // Growable buffer that reassembles the frames streamed from a node.
+    struct Receivebuffer_t
+    {
+        std::vector<char> Storage = std::vector<char>(4096);
+        size_t Head{}, Tail{};
+
+        // Ensure there's space for at least one more max-sized frame.
+        std::span<char> Writable()
+        {
+            // Move the pending data to the front rather than growing.
+            if (Head && (Storage.size() - Tail) < (sizeof(Framesize_t) + 0xFFFF))
+            {
+                std::memmove(Storage.data(), Storage.data() + Head, Tail - Head);
+                Tail -= Head;
+                Head = 0;
+            }
+
+            if ((Storage.size() - Tail) < 1024) Storage.resize(Storage.size() * 2);
+            return { Storage.data() + Tail, Storage.size() - Tail };
+        }
+        void Commit(size_t Count) { Tail += Count; }
+
+        // Returns the next complete frame, without the size prefix.
+        std::optional<std::string_view> Nextframe()
+        {
+            const auto Pending = Tail - Head;
+            if (Pending < sizeof(Framesize_t)) return {};
+
+            const auto Framesize = ntohs(*(const Framesize_t *)(Storage.data() + Head));
+            if (Pending < sizeof(Framesize_t) + Framesize) return {};
+
+            const std::string_view Frame(Storage.data() + Head + sizeof(Framesize_t), Framesize);
+            Head += sizeof(Framesize_t) + Framesize;
+            return Frame;
+        }
+
+        // The views from Nextframe are only valid until this is called.
+        void Reset()
+        {
+            if (Head == Tail) Head = Tail = 0;
+        }
+    };
+
+    // Uncompressed packets are shared between all nodes they are queued for.
+    using Frame_t = std::shared_ptr<const std::string>;
+
+    // A slow node may not hold more than this, older frames are dropped first.
+    constexpr size_t Maxqueuedbytes = 1024 * 1024;
+
+    // Compressed bodies need to fit the 16-bit frame length.
+    static_assert(sizeof(Packet_t) + LZ4_COMPRESSBOUND(Maxblocksize) <= 0xFFFF);
+
+    struct Node_t
+    {
+        uint32_t IPv4; uint16_t Port; size_t Socket;
+
+        // Only the network thread touches the receive-buffer and decoder.
+        Receivebuffer_t Receivebuffer{};
+        Streamdecoder_t Decoder{};
+
+        // Owned by the sender thread, guarded by Sendlock.
+        std::deque<Frame_t> Sendqueue{};
+        std::string Inflight{};
+        size_t Sendoffset{}, Queuedbytes{};
+        uint64_t Sentbytes{}, Uncompressedbytes{}, Droppedframes{};
+        Streamencoder_t Encoder{};
+        Spinlock Sendlock{};
+    };
+    static Hashmap<std::string, std::shared_ptr<Node_t>> Connectednodes;
+    static Hashmap<size_t, std::string> Nodesockets;
     static Spinlock Threadsafe;
     static size_t Listensocket;
 
+    // Gossip mode relays messages through a bounded set of connections rather than a full mesh.
+    namespace Gossip
+    {
+        constexpr uint8_t Maxhops = 6;
+        constexpr size_t Fanout = 4;
+        constexpr size_t Maxnodes = 16;
+
+        // Relays forward everything to all their clients and have no connection limit.
+        #if defined(AYRIA_RELAY)
+        constexpr bool isRelay = true;
+        #else
+        constexpr bool isRelay = false;
+        #endif
+    }
+
+    // Reconciliation of the Messagestream with newly connected nodes.
+    namespace Sync
+    {
+        static void Begin(const std::string &PK);
+        static bool isControl(uint32_t Messagetype);
+    }
+
+    // Progress of the time-sliced catch-up from relays.
+    namespace Timeslices
+    {
+        static void onProgress(const std::string &Relay, uint64_t Latest, size_t Count);
+        static void onDone(const std::string &Relay, uint64_t Start, uint64_t End, size_t Count);
+    }
+
+    // Readiness notification for the sockets, epoll on Linux and WSAPoll on Windows.
+    namespace Poller
+    {
+        #if defined(__linux__)
+        static int Pollhandle{ -1 };
+        #else
+        static std::vector<WSAPOLLFD> Pollset{};
+        static Spinlock Pollsetlock{};
+        #endif
+
+        static void Insert(size_t Socket)
+        {
+            #if defined(__linux__)
+            epoll_event Event{ EPOLLIN | EPOLLRDHUP, { .fd = int(Socket) } };
+            epoll_ctl(Pollhandle, EPOLL_CTL_ADD, int(Socket), &Event);
+            #else
+            std::scoped_lock Lock(Pollsetlock);
+            Pollset.push_back({ SOCKET(Socket), POLLRDNORM, 0 });
+            #endif
+        }
+        static void Erase(size_t Socket)
+        {
+            #if defined(__linux__)
+            epoll_ctl(Pollhandle, EPOLL_CTL_DEL, int(Socket), nullptr);
+            #else
+            std::scoped_lock Lock(Pollsetlock);
+            std::erase_if(Pollset, [=](const auto &Item) { return Item.fd == SOCKET(Socket); });
+            #endif
+        }
+
+        // Returns all sockets that can be read without blocking.
+        static Inlinedvector<size_t, 32> Wait(int TimeoutMS)
+        {
+            Inlinedvector<size_t, 32> Result{};
+
+            #if defined(__linux__)
+            std::array<epoll_event, 64> Events;
+            const auto Count = epoll_wait(Pollhandle, Events.data(), int(Events.size()), TimeoutMS);
+            for (int i = 0; i < Count; ++i) Result.push_back(size_t(Events[i].data.fd));
+            #else
+            std::vector<WSAPOLLFD> Snapshot;
+            {
+                std::scoped_lock Lock(Pollsetlock);
+                Snapshot = Pollset;
+            }
+
+            // WSAPoll fails instantly on an empty set.
+            if (Snapshot.empty()) [[unlikely]]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(TimeoutMS));
+                return Result;
+            }
+
+            // Hangups and errors are also reported as ready, recv() will tell us what happened.
+            if (0 < WSAPoll(Snapshot.data(), ULONG(Snapshot.size()), TimeoutMS))
+            {
+                for (const auto &Item : Snapshot)
+                    if (Item.revents) Result.push_back(size_t(Item.fd));
+            }
+            #endif
+
+            return Result;
+        }
+
+        static bool Initialize()
+        {
+            #if defined(__linux__)
+            Pollhandle = epoll_create1(EPOLL_CLOEXEC);
+            return Pollhandle != -1;
+            #else
+            return true;
+            #endif
+        }
+    }
+
+    // Track the node and poll it for data, replaces any older connection. Returns false if we are full.
+    static bool Insertnode(const std::string &PK, uint32_t IPv4, uint16_t Port, size_t Socket)
+    {
+        // The network thread should never block on a node.
+        unsigned long Argument{ 1 };
+        ioctlsocket(Socket, FIONBIO, &Argument);
+
+        std::scoped_lock Lock(Threadsafe);
+        if (!Gossip::isRelay && Global.Settings.enableGossip && !Connectednodes.contains(PK) && Connectednodes.size() >= Gossip::Maxnodes) [[unlikely]]
+            return false;
+
+        if (Connectednodes.contains(PK))
+        {
+            const auto &Oldnode = Connectednodes[PK];
+            std::scoped_lock Sendguard(Oldnode->Sendlock);
+
+            Poller::Erase(Oldnode->Socket);
+            Nodesockets.erase(Oldnode->Socket);
+            closesocket(Oldnode->Socket);
+            Oldnode->Socket = INVALID_SOCKET;
+        }
+
+        // Both ends of a new connection start with empty streams.
+        const auto Node = std::make_shared<Node_t>(IPv4, Port, Socket);
+
+        Connectednodes[PK] = Node;
+        Nodesockets[Socket] = PK;
+        Poller::Insert(Socket);
+        return true;
+    }
+    static void Erasenode(size_t Socket)
+    {
+        std::scoped_lock Lock(Threadsafe);
+        if (!Nodesockets.contains(Socket)) [[unlikely]] return;
+
+        // The sender thread may still hold a reference to the node.
+        const auto Node = Connectednodes[Nodesockets[Socket]];
+        std::scoped_lock Sendguard(Node->Sendlock);
+        Node->Socket = INVALID_SOCKET;
+
+        Connectednodes.erase(Nodesockets[Socket]);
+        Nodesockets.erase(Socket);
+        Poller::Erase(Socket);
+        closesocket(Socket);
+    }
+
+    // Snapshot of the nodes so that we can work without holding the lock.
+    static Inlinedvector<std::shared_ptr<Node_t>, 16> getNodes()
+    {
+        Inlinedvector<std::shared_ptr<Node_t>, 16> Result{};
+
+        std::scoped_lock Lock(Threadsafe);
+        Result.reserve(Connectednodes.size());
+        for (const auto &Node : Connectednodes | std::views::values)
+            Result.push_back(Node);
+
+        return Result;
+    }
+
+    // A single thread services all send-queues, partial writes resume where they left off.
+    namespace Sender
+    {
+        // Linux waits for new frames and writable sockets in the same epoll set, Windows polls the backlog.
+        #if defined(__linux__)
+        static int Writehandle{ -1 }, Wakeevent{ -1 };
+        #else
+        static std::atomic_flag Pendingwork{};
+        #endif
+
+        static void Wakeup()
+        {
+            #if defined(__linux__)
+            eventfd_write(Wakeevent, 1);
+            #else
+            Pendingwork.test_and_set();
+            Pendingwork.notify_one();
+            #endif
+        }
+
+        static void Enqueue(const Frame_t &Frame, std::span<const std::shared_ptr<Node_t>> Nodes)
+        {
+            for (const auto &Node : Nodes)
+            {
+                std::scoped_lock Lock(Node->Sendlock);
+                Node->Sendqueue.push_back(Frame);
+                Node->Queuedbytes += Frame->size();
+
+                // Drop the oldest frames, queued frames have not been compressed yet so the stream stays intact.
+                // Reconciliation frames are kept as the other side waits for them, as is the newest frame.
+                for (auto Item = Node->Sendqueue.begin(); Node->Queuedbytes > Maxqueuedbytes && Item != std::prev(Node->Sendqueue.end());)
+                {
+                    if (Sync::isControl(((const Packet_t *)(*Item)->data())->Payload.Messagetype))
+                    {
+                        ++Item;
+                        continue;
+                    }
+
+                    Node->Queuedbytes -= (*Item)->size();
+                    Item = Node->Sendqueue.erase(Item);
+                    Node->Droppedframes++;
+                }
+            }
+
+            Wakeup();
+        }
+        static void Enqueue(const Frame_t &Frame)
+        {
+            Enqueue(Frame, getNodes());
+        }
+
+        // Compress the packet against the links history into the in-flight frame, false if it can't be framed.
+        static bool Compress(Node_t &Node, std::string_view Packet)
+        {
+            const auto Body = Packet.substr(sizeof(Packet_t));
+
+            // Larger bodies would overrun the ring and the 16-bit frame length, all producers must split them.
+            if (Body.size() > Maxblocksize) [[unlikely]]
+            {
+                Errorprint(va("Messagebus: Refusing to send a %zu byte frame, this is a bug.", Body.size()));
+                assert(false);
+                return false;
+            }
+
+            const auto Bound = LZ4_COMPRESSBOUND(int(Body.size()));
+            Node.Inflight.resize(sizeof(Framesize_t) + sizeof(Packet_t) + Bound);
+            std::memcpy(Node.Inflight.data() + sizeof(Framesize_t), Packet.data(), sizeof(Packet_t));
+
+            // The body is at most Maxblocksize, so this always fits the frame.
+            const auto Compressed = Node.Encoder.Compress(Body, Node.Inflight.data() + sizeof(Framesize_t) + sizeof(Packet_t));
+            const auto Framesize = sizeof(Packet_t) + Compressed;
+
+            *(Framesize_t *)Node.Inflight.data() = htons(Framesize_t(Framesize));
+            Node.Inflight.resize(sizeof(Framesize_t) + Framesize);
+            Node.Uncompressedbytes += sizeof(Framesize_t) + Packet.size();
+            return true;
+        }
+
+        // Returns true if the node still has data queued.
+        static bool Flush(Node_t &Node)
+        {
+            std::scoped_lock Lock(Node.Sendlock);
+
+            // Connection closed, the network thread is responsible for cleanup.
+            if (Node.Socket == INVALID_SOCKET) [[unlikely]]
+            {
+                Node.Sendqueue.clear();
+                Node.Inflight.clear();
+                Node.Queuedbytes = Node.Sendoffset = 0;
+                return false;
+            }
+
+            while (!Node.Inflight.empty() || !Node.Sendqueue.empty())
+            {
+                // Frames are only compressed once they are about to be sent, so dropping queued ones is safe.
+                if (Node.Inflight.empty())
+                {
+                    const auto Packet = std::move(Node.Sendqueue.front());
+                    Node.Queuedbytes -= Packet->size();
+                    Node.Sendqueue.pop_front();
+
+                    if (!Compress(Node, *Packet)) [[unlikely]] continue;
+                }
+
+                const auto Remaining = int(Node.Inflight.size() - Node.Sendoffset);
+                const auto Return = send(Node.Socket, Node.Inflight.data() + Node.Sendoffset, Remaining, NULL);
+
+                // The socket-buffer is full, or the node is gone and the network thread will notice.
+                if (Return == SOCKET_ERROR) return WSAGetLastError() == WSAEWOULDBLOCK;
+
+                Node.Sentbytes += Return;
+                if (Return < Remaining)
+                {
+                    Node.Sendoffset += Return;
+                    return true;
+                }
+
+                Node.Inflight.clear();
+                Node.Sendoffset = 0;
+            }
+
+            return false;
+        }
+
+        // Block until there's new work or one of the backlogged sockets drains.
+        static void Wait(std::span<const size_t> Backlogged)
+        {
+            #if defined(__linux__)
+            // One-shot so that a socket that stays writable doesn't spin us, re-armed while it's backlogged.
+            for (const auto Socket : Backlogged)
+            {
+                epoll_event Event{ EPOLLOUT | EPOLLONESHOT, { .fd = int(Socket) } };
+                if (-1 == epoll_ctl(Writehandle, EPOLL_CTL_MOD, int(Socket), &Event))
+                    epoll_ctl(Writehandle, EPOLL_CTL_ADD, int(Socket), &Event);
+            }
+
+            std::array<epoll_event, 64> Events;
+            epoll_wait(Writehandle, Events.data(), int(Events.size()), -1);
+
+            eventfd_t Count;
+            eventfd_read(Wakeevent, &Count);
+            #else
+            if (Backlogged.empty())
+            {
+                Pendingwork.wait(false);
+            }
+            else
+            {
+                // WSAPoll can't wait on the work-flag, so new frames for idle nodes may be delayed by the timeout.
+                std::vector<WSAPOLLFD> Pollset;
+                Pollset.reserve(Backlogged.size());
+                for (const auto Socket : Backlogged) Pollset.push_back({ SOCKET(Socket), POLLWRNORM, 0 });
+                WSAPoll(Pollset.data(), ULONG(Pollset.size()), 10);
+            }
+            Pendingwork.clear();
+            #endif
+        }
+
+        [[noreturn]] static void Senderthread()
+        {
+            // Name this thread for easier debugging.
+            setThreadname("Ayria_Sender");
+
+            Inlinedvector<size_t, 16> Backlogged{};
+            while (true)
+            {
+                Wait(Backlogged);
+                Backlogged.clear();
+
+                for (const auto &Node : getNodes())
+                {
+                    if (!Flush(*Node)) continue;
+
+                    // Closed sockets are removed from the epoll set automatically.
+                    std::scoped_lock Lock(Node->Sendlock);
+                    if (Node->Socket != INVALID_SOCKET) Backlogged.push_back(Node->Socket);
+                }
+            }
+        }
+
+        static bool Initialize()
+        {
+            #if defined(__linux__)
+            Writehandle = epoll_create1(EPOLL_CLOEXEC);
+            Wakeevent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (Writehandle == -1 || Wakeevent == -1) [[unlikely]] return false;
+
+            epoll_event Event{ EPOLLIN, { .fd = Wakeevent } };
+            return 0 == epoll_ctl(Writehandle, EPOLL_CTL_ADD, Wakeevent, &Event);
+            #else
+            return true;
+            #endif
+        }
+    }
+
+    // Handshakes block, so bound how long and how many of them a remote can keep around.
+    constexpr uint32_t HandshaketimeoutMS = 5000;
+    constexpr size_t Maxhandshakes = 32;
+    static std::atomic<size_t> Pendinghandshakes{};
+
     static std::string doHandshake(size_t Socket)
     {
         struct { std::array<uint8_t, 64> Signature; std::array<uint8_t, 32> Publickey; } Ours{}, Theirs{};
 
+        // Windows takes the timeout in milliseconds, POSIX as a timeval.
+        #if defined(_WIN32)
+        const DWORD Timeout = HandshaketimeoutMS;
+        #else
+        const timeval Timeout{ HandshaketimeoutMS / 1000, (HandshaketimeoutMS % 1000) * 1000 };
+        #endif
+        setsockopt(Socket, SOL_SOCKET, SO_RCVTIMEO, (const char *)&Timeout, sizeof(Timeout));
+        setsockopt(Socket, SOL_SOCKET, SO_SNDTIMEO, (const char *)&Timeout, sizeof(Timeout));
+
         const auto Sig = qDSA::Sign(*Global.Publickey, *Global.Privatekey, *Global.Publickey);
         std::ranges::copy(*Global.Publickey, Ours.Publickey.begin());
         std::ranges::move(Sig, Ours.Signature.begin());
@@ -130,7 +578,7 @@ namespace Backend::Messagebus
         do
         {
             if (static_cast<int>(sizeof(Ours)) != send(Socket, (char *)&Ours, sizeof(Ours), NULL)) [[unlikely]] break;
-            if (static_cast<int>(sizeof(Theirs)) != recv(Socket, (char *)&Theirs, sizeof(Theirs), NULL)) [[unlikely]] break;
+            if (static_cast<int>(sizeof(Theirs)) != recv(Socket, (char *)&Theirs, sizeof(Theirs), MSG_WAITALL)) [[unlikely]] break;
             if (!qDSA::Verify(Theirs.Publickey, Theirs.Signature, Theirs.Publickey)) [[unlikely]] break;
 
             return Base58::Encode<char>(Theirs.Publickey);
@@ -138,203 +586,1248 @@ namespace Backend::Messagebus
 
         return {};
     }
-    void Connectuser(uint32_t IPv4, uint16_t Port)
+    // Blocking, returns the nodes PK and if the connection is new. PK is empty on failure.
+    static std::pair<std::string, bool> Connectnode(uint32_t IPv4, uint16_t Port)
     {
-        std::thread([](uint32_t IPv4, uint16_t Port)
-        {
-            const sockaddr_in Hostinfo{ AF_INET, htons(Port), {{.S_addr = htonl(IPv4)}} };
+        const sockaddr_in Hostinfo = Makeaddress(htonl(IPv4), htons(Port));
 
-            // Check if we already have a connection to this client.
-            for (const auto &Node : Connectednodes | std::views::values)
+        // Check if we already have a connection to this client.
+        {
+            std::scoped_lock Lock(Threadsafe);
+            for (const auto &[PK, Node] : Connectednodes)
             {
-                if (Node.IPv4 == Hostinfo.sin_addr.S_un.S_addr && Node.Port == Hostinfo.sin_port)
-                    return;
+                if (Node->IPv4 == Hostinfo.sin_addr.s_addr && Node->Port == Hostinfo.sin_port)
+                    return { PK, false };
             }
 
-            const auto Socket = socket(AF_INET, SOCK_STREAM, 0);
-            if (Socket == INVALID_SOCKET) return;
+            if (!Gossip::isRelay && Global.Settings.enableGossip && Connectednodes.size() >= Gossip::Maxnodes) [[unlikely]]
+                return {};
+        }
 
-            do
-            {
-                if (0 != connect(Socket, PSOCKADDR(&Hostinfo), sizeof(Hostinfo))) [[unlikely]]
-                    break;
+        const auto Socket = socket(AF_INET, SOCK_STREAM, 0);
+        if (Socket == INVALID_SOCKET) return {};
 
-                const auto PK = doHandshake(Socket);
-                if (PK.empty()) [[unlikely]] break;
+        do
+        {
+            if (0 != connect(Socket, PSOCKADDR(&Hostinfo), sizeof(Hostinfo))) [[unlikely]]
+                break;
 
-                std::scoped_lock Lock(Threadsafe);
-                if (Connectednodes.contains(PK)) closesocket(Connectednodes[PK].Socket);
-                Connectednodes[PK] = { Hostinfo.sin_addr.S_un.S_addr, Hostinfo.sin_port, Socket };
-                return;
+            const auto PK = doHandshake(Socket);
+            if (PK.empty()) [[unlikely]] break;
 
-            } while (false);
+            if (Insertnode(PK, Hostinfo.sin_addr.s_addr, Hostinfo.sin_port, Socket)) [[likely]]
+                return { PK, true };
 
-            closesocket(Socket);
+        } while (false);
+
+        closesocket(Socket);
+        return {};
+    }
+    void Connectuser(uint32_t IPv4, uint16_t Port)
+    {
+        std::thread([](uint32_t IPv4, uint16_t Port)
+        {
+            // The connecting side starts the reconciliation.
+            if (const auto [PK, isNew] = Connectnode(IPv4, Port); isNew)
+                Sync::Begin(PK);
         }, IPv4, Port).detach();
     }
-    static void Acceptconnection()
+    static void Acceptconnections()
     {
-        std::thread([]()
+        // The listen-socket is non-blocking, so take everything that's queued.
+        while (true)
         {
-            sockaddr_in Sockinfo{}; int Len = sizeof(Sockinfo);
+            sockaddr_in Sockinfo{}; socklen_t Len = sizeof(Sockinfo);
             const auto Socket = accept(Listensocket, PSOCKADDR(&Sockinfo), &Len);
+            if (Socket == INVALID_SOCKET) break;
 
-            const auto PK = doHandshake(Socket);
-            if (PK.empty()) [[unlikely]]
+            // Anyone can connect, so refuse rather than queue when too many are stalling.
+            if (++Pendinghandshakes > Maxhandshakes) [[unlikely]]
             {
+                Pendinghandshakes--;
                 closesocket(Socket);
-                return;
+                continue;
             }
 
-            std::scoped_lock Lock(Threadsafe);
-            if (Connectednodes.contains(PK)) closesocket(Connectednodes[PK].Socket);
-            Connectednodes[PK] = { Sockinfo.sin_addr.S_un.S_addr, Sockinfo.sin_port, Socket };
-        }).detach();
-    }
+            // The handshake blocks on the remote, so do it in the background.
+            std::thread([](size_t Socket, sockaddr_in Sockinfo)
+            {
+                // Accepted sockets inherit the listen-sockets non-blocking mode.
+                unsigned long Argument{ 0 };
+                ioctlsocket(Socket, FIONBIO, &Argument);
 
-    static Hashset<std::string> Cachedclients{};
-    void Publish(std::string_view Identifier, std::string_view Payload)
-    {
-        // One can always dream..
-        if (!Base85::isValid(Payload)) [[likely]]
-        {
-            const auto Size = Base85::Encodesize_padded(Payload.size());
-            const auto Buffer = static_cast<char*>(alloca(Size));
-            Base85::Encode(Payload, Buffer);
-            Payload = { Buffer, Size };
+                const auto PK = doHandshake(Socket);
+                if (PK.empty() || !Insertnode(PK, Sockinfo.sin_addr.s_addr, Sockinfo.sin_port, Socket)) [[unlikely]]
+                    closesocket(Socket);
+
+                Pendinghandshakes--;
+            }, Socket, Sockinfo).detach();
         }
+    }
 
-        // Create the buffer with a bit of overhead in case the subsystem needs to modify it.
-        auto Buffer = std::make_unique<char []>(sizeof(Packet_t) + LZ4_COMPRESSBOUND(Payload.size()));
-        const auto Packet = reinterpret_cast<Packet_t*>(Buffer.get());
+    // Messages are either signed directly, or the signature is followed by a Merkle-proof.
+    static std::optional<std::string> getVerifieddata(std::string_view Signature, std::string &&Signeddata)
+    {
+        if (Signature.size() < 64) [[unlikely]] return {};
+        if (Signature.size() == 64) return std::move(Signeddata);
+        return Merkle::Root(Signeddata, Signature.substr(64));
+    }
+    static bool Verifymessage(const std::array<uint8_t, 32> &Publickey, std::string_view Signature, std::string &&Signeddata)
+    {
+        const auto Data = getVerifieddata(Signature, std::move(Signeddata));
+        return Data && qDSA::Verify(Publickey, std::span(reinterpret_cast<const uint8_t *>(Signature.data()), 64), *Data);
+    }
 
-        // Build the packet..
-        std::ranges::copy(Payload, Packet->Payload.Message);
-        Packet->Payload.Messagetype = Hash::WW32(Identifier);
-        Packet->Payload.Timestamp = std::chrono::utc_clock::now().time_since_epoch().count();
-        Packet->Signature = qDSA::Sign(*Global.Publickey, *Global.Privatekey, std::span((uint8_t *)&Packet->Payload, sizeof(Payload_t) + Payload.size()));
+    // The signature covers the header as well as the message.
+    static std::string getSigneddata(uint32_t Messagetype, uint64_t Timestamp, std::string_view Message)
+    {
+        const Payload_t Header{ Messagetype, Timestamp };
+        return std::string((const char *)&Header, sizeof(Payload_t)).append(Message);
+    }
 
-        // Save our own packets so we can have unified processing.
+    // Save the message for our internal synchronization, binary data is stored as BLOBs.
+    static bool Insertmessage(const std::string &Sender, uint32_t Messagetype, uint64_t Timestamp, std::string_view Signature, std::string_view Message)
+    {
         try
         {
             Backend::Database()
                 << "INSERT INTO Messagestream VALUES (?,?,?,?,?,?);"
-                << Global.getLongID() << Hash::WW32(Identifier) << Packet->Payload.Timestamp
-                << Base85::Encode<char>(Packet->Signature)
-                << std::string(Payload) << false;
-        } catch (...) {}
+                << Sender << Messagetype << Timestamp
+                << std::vector<char>(Signature.begin(), Signature.end())
+                << std::vector<char>(Message.begin(), Message.end()) << false;
+            return true;
+        } catch (...) { return false; }
+    }
 
-        // Hard-lock: if networking is disabled, or the client is private, don't send anything.
-        if (Global.Settings.noNetworking || Global.Settings.isPrivate) [[unlikely]] return;
+    // Layer 2 gets new messages directly, the DB is only read back for recovery.
+    static void Storemessage(const std::string &Sender, uint32_t Messagetype, uint64_t Timestamp, std::string_view Signature, std::string_view Message)
+    {
+        bool isInserted{};
+        {
+            std::scoped_lock Lock(Backend::Transactionlock());
+            isInserted = Insertmessage(Sender, Messagetype, Timestamp, Signature, Message);
+        }
 
-        // The payload is Base85 so it should compress reasonably well.
-        const auto Compressed = LZ4_compress_default(Payload.data(), Packet->Payload.Message, (int)Payload.size(), LZ4_COMPRESSBOUND((int)Payload.size()));
-        std::thread([](std::unique_ptr<char[]> &&Buffer, int Payloadsize)
+        if (isInserted)
+            Layer2::Enqueue({ { Sender, Messagetype, Timestamp, std::string(Signature), std::string(Message), std::chrono::steady_clock::now() } });
+    }
+
+    namespace Gossip
+    {
+        // Rotating Bloom-filter over (Sender, Signature), the older generation is cleared when the current one fills up.
+        namespace Seen
         {
-            for (const auto &Node : Connectednodes | std::views::values)
+            constexpr size_t Filterbits = 1 << 20, Capacity = 1 << 16, Hashcount = 7;
+            static std::array<std::bitset<Filterbits>, 2> Generations{};
+            static size_t Current{}, Insertions{};
+            static Spinlock Filterlock{};
+
+            static std::array<size_t, Hashcount> getIndices(const std::array<uint8_t, 32> &Sender, const std::array<uint8_t, 64> &Signature)
             {
-                send(Node.Socket, Buffer.get(), Payloadsize, NULL);
+                std::array<uint8_t, 96> Key;
+                std::ranges::copy(Sender, Key.begin());
+                std::ranges::copy(Signature, Key.begin() + 32);
+
+                // Double hashing, the signature is random enough that one hash suffices.
+                const auto Hash = Hash::WW64(Key);
+                const auto H1 = uint32_t(Hash), H2 = uint32_t(Hash >> 32) | 1;
+
+                std::array<size_t, Hashcount> Result;
+                for (size_t i = 0; i < Hashcount; ++i)
+                    Result[i] = (H1 + i * H2) % Filterbits;
+                return Result;
             }
-        }, std::move(Buffer), Compressed + sizeof(Packet_t)).detach();
-    }
-    static void handleMessage(const std::string &PK, std::string_view Packet)
-    {
-        std::array<uint8_t, 32> Publickey; Base58::Decode(PK, Publickey.data());
-        const auto Header = reinterpret_cast<const Packet_t*>(Packet.data());
-        auto Payload = Packet.substr(sizeof(Packet_t));
 
-        // Decompress the payload.
-        const auto Buffer = std::make_unique<char[]>(Payload.size() * 3);
-        const auto Size = LZ4_decompress_safe(Payload.data(), Buffer.get(), (int)Payload.size(), (int)Payload.size() * 3);
-        Payload = { Buffer.get(), static_cast<size_t>(Size) };
+            static bool Contains(const std::array<uint8_t, 32> &Sender, const std::array<uint8_t, 64> &Signature)
+            {
+                const auto Indices = getIndices(Sender, Signature);
 
-        // Verify the packets signature (in-case someone forwarded it and it got corrupted).
-        if (!qDSA::Verify(Publickey, Header->Signature, Payload)) return;
+                std::scoped_lock Lock(Filterlock);
+                return std::ranges::any_of(Generations, [&](const auto &Filter)
+                {
+                    return std::ranges::all_of(Indices, [&](size_t Index) { return Filter.test(Index); });
+                });
+            }
+            static void Insert(const std::array<uint8_t, 32> &Sender, const std::array<uint8_t, 64> &Signature)
+            {
+                const auto Indices = getIndices(Sender, Signature);
 
-        // Check that the packet isn't from the future.
-        if (Header->Payload.Timestamp > (uint64_t)std::chrono::utc_clock::now().time_since_epoch().count()) [[unlikely]] return;
+                std::scoped_lock Lock(Filterlock);
+                if (++Insertions > Capacity) [[unlikely]]
+                {
+                    Current ^= 1;
+                    Generations[Current].reset();
+                    Insertions = 1;
+                }
 
-        // Ensure that the PK exists in the DB.
-        if (!Cachedclients.contains(PK) && !AyriaAPI::Clientinfo::Find(PK)) [[unlikely]]
-        {
-            try { Backend::Database() << "INSERT INTO Account VALUES (?);" << PK; } catch (...) {}
-            Cachedclients.insert(PK);
+                for (const auto Index : Indices) Generations[Current].set(Index);
+            }
         }
 
-        // Save the packet for our internal synchronization.
-        try
+        // Forward a verified message to a random subset of our nodes, excluding where it came from.
+        static void Relay(const std::string &Link, const std::string &Origin, const Packet_t *Header, std::string_view Payload)
         {
-            Backend::Database()
-                << "INSERT INTO Messagestream VALUES (?,?,?,?,?,?);"
-                << PK << Header->Payload.Messagetype << Header->Payload.Timestamp
-                << Base85::Encode<char>(Header->Signature)
-                << std::string(Payload) << false;
-        } catch (...) {}
-    }
+            // Nodes can put anything in the header, so don't let them extend the reach past ours.
+            const auto Hops = std::min<uint8_t>(Header->Hops, Maxhops);
 
-    static void __cdecl doNetworking()
-    {
-        fd_set ReadFD{};
-        FD_SET(Listensocket, &ReadFD);
-        for (const auto &Node : Connectednodes)
-            FD_SET(Node.second.Socket, &ReadFD);
+            if (!(Gossip::isRelay || Global.Settings.enableGossip) || Hops == 0) return;
+            if (Global.Settings.noNetworking || Global.Settings.isPrivate) [[unlikely]] return;
 
-        // Check for data on the sockets.
-        constexpr timeval Defaulttimeout{ NULL, 1 };
-        const auto Count{ ReadFD.fd_count };
-        auto Timeout{ Defaulttimeout };
+            Inlinedvector<std::shared_ptr<Node_t>, 16> Targets{};
+            {
+                std::scoped_lock Lock(Threadsafe);
+                for (const auto &[PK, Node] : Connectednodes)
+                    if (PK != Link && PK != Origin) Targets.push_back(Node);
+            }
+            if (Targets.empty()) return;
 
-        if (!select(Count, &ReadFD, nullptr, nullptr, &Timeout)) [[likely]]
-            return;
+            // A constant fan-out is enough for the message to reach everyone in O(log N) rounds.
+            if (!isRelay && Targets.size() > Fanout)
+            {
+                static std::mt19937_64 RNG{ std::random_device{}() };
+                std::ranges::shuffle(Targets, RNG);
+                Targets.resize(Fanout);
+            }
 
-        if (FD_ISSET(Listensocket, &ReadFD))
-            Acceptconnection();
+            auto Forwarded = *Header;
+            Forwarded.Hops = Hops - 1;
 
-        for (const auto &[PK, Node] : Connectednodes)
-        {
-            if (!FD_ISSET(Node.Socket, &ReadFD)) [[likely]] continue;
+            auto Packet = std::string((const char *)&Forwarded, sizeof(Packet_t)).append(Payload);
+            Sender::Enqueue(std::make_shared<const std::string>(std::move(Packet)), Targets);
+        }
+    }
+
+    // Many messages at once, e.g. during catch-up. One transaction and statement rather than one per message.
+    using Storeentry_t = Layer2::Message_t;
+    static void Storemessages(std::vector<Storeentry_t> &&Entries)
+    {
+        if (Entries.empty()) return;
 
-            uint16_t Wanted{};
-            const auto Return = recv(Node.Socket, (char *)&Wanted, sizeof(Wanted), MSG_PEEK);
-            if (Return < static_cast<int>(sizeof(Wanted))) [[unlikely]]
+        std::vector<bool> isInserted(Entries.size());
+        std::unique_lock Lock(Backend::Transactionlock());
+        auto Database = Backend::Database();
+        bool isTransaction{};
+        try
+        {
+            Database << "BEGIN TRANSACTION;"; isTransaction = true;
             {
-                if (Return == 0) // Connection closed.
+                auto Statement = Database << "INSERT INTO Messagestream VALUES (?,?,?,?,?,?);";
+                for (const auto &[Index, Entry] : lz::enumerate(Entries))
                 {
-                    closesocket(Node.Socket);
-                    Connectednodes.erase(PK);
-                    break;
+                    // Duplicates only fail their own statement, not the transaction.
+                    try
+                    {
+                        Statement << Entry.Sender << Entry.Messagetype << Entry.Timestamp
+                                  << std::vector<char>(Entry.Signature.begin(), Entry.Signature.end())
+                                  << std::vector<char>(Entry.Message.begin(), Entry.Message.end()) << false;
+                        Statement.execute();
+                        isInserted[Index] = true;
+                    } catch (const sqlite::errors::constraint &) {}
                 }
-                continue;
             }
+            Database << "COMMIT;";
+        }
+        catch (...)
+        {
+            // Nobody else can hold a transaction, so the fallback commits each row on its own.
+            if (isTransaction) try { Database << "ROLLBACK;"; } catch (...) {}
 
-            DWORD Available{};
-            if (SOCKET_ERROR == ioctlsocket(Node.Socket, FIONREAD, &Available)) [[unlikely]]
-                continue;
-
-            const int Total = ntohs(Wanted) + sizeof(Wanted);
-            if ((int)Available >= Total) [[likely]]
-            {
-                const auto Buffer = static_cast<char*>(alloca(Total));
+            for (const auto &[Index, Entry] : lz::enumerate(Entries))
+                isInserted[Index] = Insertmessage(Entry.Sender, Entry.Messagetype, Entry.Timestamp, Entry.Signature, Entry.Message);
+        }
+        Lock.unlock();
 
-                if (Total > recv(Node.Socket, Buffer, Total, NULL)) [[unlikely]]
-                    break;
+        // Only once the rows are committed, either way, so that Layer 2 never sees uncommitted rows.
+        std::vector<Storeentry_t> Inserted{}; Inserted.reserve(Entries.size());
+        for (size_t i = 0; i < Entries.size(); ++i)
+            if (isInserted[i]) Inserted.push_back(std::move(Entries[i]));
 
-                handleMessage(PK, { Buffer, Wanted });
-                break;
-            }
-        }
+        Layer2::Enqueue(std::move(Inserted));
     }
-    void Initialize(bool doLANDiscovery)
-    {
-        do
-        {
-            WSADATA Unused;
-            (void)WSAStartup(MAKEWORD(1, 1), &Unused);
 
-            Listensocket = socket(AF_INET, SOCK_STREAM, 0);
-            if (Listensocket == INVALID_SOCKET) break;
+    // Queue the packet for all nodes, the sender compresses it per link.
+    static void Sendpacket(const std::array<uint8_t, 64> &Signature, uint32_t Messagetype, uint64_t Timestamp, std::string_view Body)
+    {
+        // Our own messages will be echoed back by the gossip.
+        Gossip::Seen::Insert(*Global.Publickey, Signature);
 
-            BOOL Argument{ 0 }; // Enable Nagles algorithm.
+        // Hard-lock: if networking is disabled, or the client is private, don't send anything.
+        if (Global.Settings.noNetworking || Global.Settings.isPrivate) [[unlikely]] return;
+
+        // Can't be represented in the frame header, the caller needs to split the message.
+        if (Body.size() > Maxblocksize) [[unlikely]]
+        {
+            Errorprint(va("Messagebus: Dropping oversized message of type 0x%08X.", Messagetype));
+            return;
+        }
+
+        const Packet_t Header{ *Global.Publickey, Signature, Gossip::Maxhops, { Messagetype, Timestamp } };
+        auto Packet = std::string((const char *)&Header, sizeof(Packet_t)).append(Body);
+        Sender::Enqueue(std::make_shared<const std::string>(std::move(Packet)));
+    }
+
+    // Opt-in, amortize the signing over multiple messages at the cost of some latency.
+    namespace Batching
+    {
+        // Body = { Payload_t Header; uint16_t Length; char Message[Length]; }[]
+        constexpr uint32_t Batchtype = Hash::WW32("Messagebus::Batch");
+        constexpr size_t Maxbatchsize = 48 * 1024;
+        constexpr size_t Maxbatchcount = 64;
+
+        using Entry_t = struct { uint32_t Messagetype; uint64_t Timestamp; std::string Message; };
+        static std::vector<Entry_t> Pending{};
+        static size_t Pendingsize{};
+        static Spinlock Batchlock{};
+
+        static void Sendbatch(std::vector<Entry_t> &&Entries)
+        {
+            std::vector<std::string> Leaves{}; Leaves.reserve(Entries.size());
+            std::string Body{}; Body.reserve(Maxbatchsize);
+
+            for (const auto &Entry : Entries)
+            {
+                const Payload_t Header{ Entry.Messagetype, Entry.Timestamp };
+                const auto Length = uint16_t(Entry.Message.size());
+
+                Body.append((const char *)&Header, sizeof(Header));
+                Body.append((const char *)&Length, sizeof(Length));
+                Body.append(Entry.Message);
+                Leaves.push_back(Merkle::Leaf(getSigneddata(Entry.Messagetype, Entry.Timestamp, Entry.Message)));
+            }
+
+            const auto Tree = Merkle::Build(std::move(Leaves));
+            const auto Signature = qDSA::Sign(*Global.Publickey, *Global.Privatekey, Tree.back().front());
+            const auto Sigstring = std::string((const char *)Signature.data(), Signature.size());
+
+            // Each message is stored with its own proof so that it can be verified and forwarded alone.
+            for (const auto &[Index, Entry] : lz::enumerate(Entries))
+                Storemessage(Global.getLongID(), Entry.Messagetype, Entry.Timestamp, Sigstring + Merkle::Proof(Tree, uint32_t(Index)), Entry.Message);
+
+            Sendpacket(Signature, Batchtype, Entries.back().Timestamp, Body);
+        }
+
+        static void __cdecl Flush()
+        {
+            std::vector<Entry_t> Entries{};
+            {
+                std::scoped_lock Lock(Batchlock);
+                Entries.swap(Pending);
+                Pendingsize = 0;
+            }
+
+            if (!Entries.empty()) Sendbatch(std::move(Entries));
+        }
+        static void Enqueue(uint32_t Messagetype, uint64_t Timestamp, std::string_view Message)
+        {
+            const auto Entrysize = sizeof(Payload_t) + sizeof(uint16_t) + Message.size();
+            std::vector<Entry_t> Overflow{}, Full{};
+
+            {
+                std::scoped_lock Lock(Batchlock);
+
+                // Would not fit in the frame, so send what we have first.
+                if (Pendingsize + Entrysize > Maxbatchsize) [[unlikely]]
+                {
+                    Overflow.swap(Pending);
+                    Pendingsize = 0;
+                }
+
+                Pending.emplace_back(Messagetype, Timestamp, std::string(Message));
+                Pendingsize += Entrysize;
+
+                if (Pending.size() >= Maxbatchcount)
+                {
+                    Full.swap(Pending);
+                    Pendingsize = 0;
+                }
+            }
+
+            if (!Overflow.empty()) [[unlikely]] Sendbatch(std::move(Overflow));
+            if (!Full.empty()) Sendbatch(std::move(Full));
+        }
+
+        // Returns false if the body is malformed.
+        static bool Parse(std::string_view Body, std::vector<std::pair<Payload_t, std::string_view>> &Entries)
+        {
+            while (!Body.empty())
+            {
+                if (Body.size() < sizeof(Payload_t) + sizeof(uint16_t)) [[unlikely]] return false;
+
+                const auto Header = *(const Payload_t *)Body.data();
+                const auto Length = *(const uint16_t *)(Body.data() + sizeof(Payload_t));
+                Body.remove_prefix(sizeof(Payload_t) + sizeof(uint16_t));
+
+                if (Body.size() < Length) [[unlikely]] return false;
+                Entries.emplace_back(Header, Body.substr(0, Length));
+                Body.remove_prefix(Length);
+            }
+
+            return !Entries.empty();
+        }
+    }
+
+    // Ensure that the PK exists in the DB.
+    static Hashset<std::string> Cachedclients{};
+    static void Ensureaccount(const std::string &PK)
+    {
+        if (!Cachedclients.contains(PK) && !AyriaAPI::Clientinfo::Find(PK)) [[unlikely]]
+        {
+            // Shares the connection with the transactions of other threads.
+            std::scoped_lock Lock(Backend::Transactionlock());
+            try { Backend::Database() << "INSERT INTO Account VALUES (?);" << PK; } catch (...) {}
+            Cachedclients.insert(PK);
+        }
+    }
+
+    void Publish(std::string_view Identifier, std::string_view Payload)
+    {
+        const auto Messagetype = Hash::WW32(Identifier);
+        const auto Timestamp = uint64_t(std::chrono::utc_clock::now().time_since_epoch().count());
+
+        // Larger messages are not worth the delay, and would not fit in a batch anyway.
+        if (Global.Settings.enableBatching && Payload.size() <= Batching::Maxbatchsize / 4)
+        {
+            Batching::Enqueue(Messagetype, Timestamp, Payload);
+            return;
+        }
+
+        const auto Signature = qDSA::Sign(*Global.Publickey, *Global.Privatekey, getSigneddata(Messagetype, Timestamp, Payload));
+
+        // Save our own packets so we can have unified processing.
+        Storemessage(Global.getLongID(), Messagetype, Timestamp, { (const char *)Signature.data(), Signature.size() }, Payload);
+        Sendpacket(Signature, Messagetype, Timestamp, Payload);
+    }
+    // Inbound messages pass through three stages, so that the network thread only copies frames:
+    // a pool of workers verifies the signatures, and a single thread persists the results in arrival order.
+    namespace Ingest
+    {
+        using Verified_t = struct { std::vector<Storeentry_t> Entries; std::function<void()> onStored; };
+        using Job_t = struct { uint64_t Sequence; std::chrono::steady_clock::time_point Received; std::function<Verified_t()> Verify; };
+
+        // Gossip can be recovered through reconciliation, so shed load rather than growing without bounds.
+        constexpr size_t Maxpending = 16384;
+
+        static std::mutex Verifylock, Persistlock;
+        static std::condition_variable Verifysignal, Persistsignal;
+        static Hashmap<uint64_t, Verified_t> Completed{};
+        static std::queue<Job_t> Verifyqueue{};
+        static uint64_t Nextsequence{};
+        static size_t Droppedjobs{};
+
+        // Control-frames are never dropped, as the peer waits for our reply.
+        static void Enqueue(std::function<Verified_t()> &&Verify, bool isOptional = true)
+        {
+            {
+                std::scoped_lock Lock(Verifylock);
+                if (isOptional && Verifyqueue.size() >= Maxpending) [[unlikely]]
+                {
+                    if (Droppedjobs++ % Maxpending == 0) Warningprint("Messagebus: Verification is falling behind, dropping messages.");
+                    return;
+                }
+
+                Verifyqueue.push({ Nextsequence++, std::chrono::steady_clock::now(), std::move(Verify) });
+            }
+            Verifysignal.notify_one();
+        }
+
+        [[noreturn]] static void Verifythread()
+        {
+            // Name this thread for easier debugging.
+            setThreadname("Ayria_Verifier");
+
+            while (true)
+            {
+                Job_t Job{};
+                {
+                    std::unique_lock Lock(Verifylock);
+                    Verifysignal.wait(Lock, [] { return !Verifyqueue.empty(); });
+                    Job = std::move(Verifyqueue.front());
+                    Verifyqueue.pop();
+                }
+
+                // Failed jobs still need to be completed, or the persistence stage would wait for them forever.
+                Verified_t Result{};
+                try { Result = Job.Verify(); } catch (...) {}
+                for (auto &Entry : Result.Entries) Entry.Received = Job.Received;
+
+                {
+                    std::scoped_lock Lock(Persistlock);
+                    Completed.emplace(Job.Sequence, std::move(Result));
+                }
+                Persistsignal.notify_one();
+            }
+        }
+
+        [[noreturn]] static void Persistthread()
+        {
+            // Name this thread for easier debugging.
+            setThreadname("Ayria_Persist");
+
+            uint64_t Nextpersist{};
+            while (true)
+            {
+                std::vector<Verified_t> Ready{};
+                {
+                    std::unique_lock Lock(Persistlock);
+                    Persistsignal.wait(Lock, [&] { return Completed.contains(Nextpersist); });
+
+                    // Take everything that is in order, one transaction is cheaper than many.
+                    for (auto Item = Completed.find(Nextpersist); Item != Completed.end(); Item = Completed.find(++Nextpersist))
+                    {
+                        Ready.push_back(std::move(Item->second));
+                        Completed.erase(Item);
+                    }
+                }
+
+                std::vector<Storeentry_t> Entries{};
+                for (auto &Item : Ready)
+                {
+                    for (auto &Entry : Item.Entries)
+                    {
+                        Ensureaccount(Entry.Sender);
+                        Entries.push_back(std::move(Entry));
+                    }
+                }
+                Storemessages(std::move(Entries));
+
+                for (const auto &Item : Ready)
+                    if (Item.onStored) Item.onStored();
+            }
+        }
+
+        // Leave a core for the network and persistence threads.
+        static void Initialize()
+        {
+            const auto Workers = std::max(2U, std::thread::hardware_concurrency()) - 1;
+            for (uint32_t i = 0; i < Workers; ++i) std::thread(Verifythread).detach();
+            std::thread(Persistthread).detach();
+        }
+    }
+
+    static Ingest::Verified_t verifyMessage(const std::string &Link, const Packet_t *Header, std::string_view Payload)
+    {
+        // Relayed messages are verified against the original sender rather than the link.
+        const auto &Publickey = Header->Sender;
+        const auto PK = Base58::Encode<char>(Publickey);
+        const auto isBatch = Header->Payload.Messagetype == Batching::Batchtype;
+
+        std::vector<std::pair<Payload_t, std::string_view>> Entries{};
+        std::string Signature((const char *)Header->Signature.data(), Header->Signature.size());
+
+        // Verify the packets signature (in-case someone forwarded it and it got corrupted).
+        if (isBatch)
+        {
+            if (!Batching::Parse(Payload, Entries)) [[unlikely]] return {};
+
+            std::vector<std::string> Leaves{}; Leaves.reserve(Entries.size());
+            for (const auto &[Entryheader, Message] : Entries)
+                Leaves.push_back(Merkle::Leaf(getSigneddata(Entryheader.Messagetype, Entryheader.Timestamp, Message)));
+
+            const auto Tree = Merkle::Build(std::move(Leaves));
+            if (!qDSA::Verify(Publickey, Header->Signature, Tree.back().front())) [[unlikely]] return {};
+
+            Gossip::Seen::Insert(Header->Sender, Header->Signature);
+            Gossip::Relay(Link, PK, Header, Payload);
+
+            Ingest::Verified_t Result{};
+            const auto Currenttime = (uint64_t)std::chrono::utc_clock::now().time_since_epoch().count();
+            for (const auto &[Index, Entry] : lz::enumerate(Entries))
+            {
+                // Check that the message isn't from the future.
+                if (Entry.first.Timestamp > Currenttime) [[unlikely]] continue;
+                Result.Entries.push_back({ PK, Entry.first.Messagetype, Entry.first.Timestamp, Signature + Merkle::Proof(Tree, uint32_t(Index)), std::string(Entry.second) });
+            }
+
+            return Result;
+        }
+
+        if (!Verifymessage(Publickey, Signature, getSigneddata(Header->Payload.Messagetype, Header->Payload.Timestamp, Payload))) return {};
+
+        // Check that the packet isn't from the future.
+        if (Header->Payload.Timestamp > (uint64_t)std::chrono::utc_clock::now().time_since_epoch().count()) [[unlikely]] return {};
+
+        Gossip::Seen::Insert(Header->Sender, Header->Signature);
+        Gossip::Relay(Link, PK, Header, Payload);
+
+        return { { { PK, Header->Payload.Messagetype, Header->Payload.Timestamp, Signature, std::string(Payload) } } };
+    }
+    static void handleMessage(const std::string &Link, const Packet_t *Header, std::string_view Payload)
+    {
+        // With gossip we'll see most messages more than once, without it the filters false-positives would only lose messages.
+        const auto isGossip = Gossip::isRelay || Global.Settings.enableGossip;
+        if ((isGossip || Base58::Encode<char>(Header->Sender) != Link) && Gossip::Seen::Contains(Header->Sender, Header->Signature)) return;
+
+        // The frame is only valid until the next read, so the job needs its own copy.
+        Ingest::Enqueue([Link, Frame = std::string((const char *)Header, sizeof(Packet_t)).append(Payload)]()
+        {
+            const auto Packetheader = reinterpret_cast<const Packet_t *>(Frame.data());
+            return verifyMessage(Link, Packetheader, std::string_view(Frame).substr(sizeof(Packet_t)));
+        });
+    }
+
+    // Anti-entropy, peers compare fingerprints of time-ranges and only exchange the messages the other is missing.
+    namespace Sync
+    {
+        // Control frames are unsigned and only meaningful to the link they arrive on.
+        constexpr uint32_t Rangestype = Hash::WW32("Messagebus::Sync::Ranges");
+        constexpr uint32_t IDstype = Hash::WW32("Messagebus::Sync::IDs");
+        constexpr uint32_t Itemstype = Hash::WW32("Messagebus::Sync::Items");
+        constexpr uint32_t Sliceitemstype = Hash::WW32("Messagebus::Sync::Sliceitems");
+        constexpr uint32_t Fetchtype = Hash::WW32("Messagebus::Sync::Fetch");
+        constexpr uint32_t Fetcheddonetype = Hash::WW32("Messagebus::Sync::Fetchdone");
+
+        #pragma pack(push, 1)
+        struct IDlist_t { uint64_t Start, End; uint8_t isFinal; };
+        struct Item_t { std::array<uint8_t, 32> Sender; uint32_t Messagetype; uint64_t Timestamp; uint16_t Signaturelength; uint32_t Messagelength; };
+        struct Fetch_t { uint64_t Start, End; };
+        struct Fetchdone_t { uint64_t Start, End; uint64_t Count; };
+        #pragma pack(pop)
+
+        static std::vector<Entry_t> getEntries(uint64_t Start, uint64_t End)
+        {
+            std::vector<Entry_t> Result{};
+
+            try
+            {
+                Backend::Database()
+                    << "SELECT rowid, Timestamp, Sender, Signature FROM Messagestream WHERE Timestamp >= ? AND Timestamp < ? ORDER BY Timestamp;"
+                    << Start << End
+                    >> [&](int64_t RowID, uint64_t Timestamp, const std::string &Sender, const std::vector<char> &Signature)
+                    {
+                        Result.emplace_back(RowID, Timestamp, Hash::WW64(Sender + std::string(Signature.begin(), Signature.end())));
+                    };
+            } catch (...) {}
+
+            return Result;
+        }
+        static std::shared_ptr<Node_t> getNode(const std::string &PK)
+        {
+            std::scoped_lock Lock(Threadsafe);
+            if (!Connectednodes.contains(PK)) [[unlikely]] return {};
+            return Connectednodes[PK];
+        }
+        static void Sendcontrol(const std::string &PK, uint32_t Messagetype, std::string_view Body)
+        {
+            const auto Node = getNode(PK);
+            if (!Node) [[unlikely]] return;
+
+            // Same limit as Sendpacket, the callers are responsible for splitting their replies.
+            if (Body.size() > Maxblocksize) [[unlikely]]
+            {
+                Errorprint(va("Messagebus: Dropping oversized control message of type 0x%08X.", Messagetype));
+                return;
+            }
+
+            const Packet_t Header{ *Global.Publickey, {}, 0, { Messagetype, 0 } };
+            auto Packet = std::string((const char *)&Header, sizeof(Packet_t)).append(Body);
+            Sender::Enqueue(std::make_shared<const std::string>(std::move(Packet)), std::span(&Node, 1));
+        }
+        static void sendIDs(const std::string &PK, uint64_t Start, uint64_t End, bool isFinal, const std::vector<Entry_t> &Entries)
+        {
+            constexpr size_t Chunksize = (Maxblocksize - sizeof(IDlist_t)) / sizeof(uint64_t);
+
+            for (const auto &Chunk : Chunkentries(Start, End, Entries, Chunksize))
+            {
+                const IDlist_t Header{ Chunk.Start, Chunk.End, isFinal };
+                std::string Body((const char *)&Header, sizeof(Header));
+                for (const auto &Entry : Chunk.Entries) Body.append((const char *)&Entry.ID, sizeof(Entry.ID));
+
+                Sendcontrol(PK, IDstype, Body);
+            }
+        }
+        // Appends the item to the body, flushing it first if it would not fit in a frame.
+        static void Appenditem(const std::string &PK, uint32_t Replytype, std::string &Body, const std::string &Sender, uint32_t Messagetype, uint64_t Timestamp, const std::vector<char> &Signature, const std::vector<char> &Message)
+        {
+            Item_t Item{ {}, Messagetype, Timestamp, uint16_t(Signature.size()), uint32_t(Message.size()) };
+            const auto Itemsize = sizeof(Item_t) + Signature.size() + Message.size();
+            if (Itemsize > Maxblocksize || Signature.size() > 0xFFFF) [[unlikely]] return;
+            Base58::Decode(Sender, Item.Sender.data());
+
+            if (Body.size() + Itemsize > Maxblocksize)
+            {
+                Sendcontrol(PK, Replytype, Body);
+                Body.clear();
+            }
+
+            Body.append((const char *)&Item, sizeof(Item));
+            Body.append(Signature.data(), Signature.size());
+            Body.append(Message.data(), Message.size());
+        }
+        static void sendItems(const std::string &PK, const std::vector<int64_t> &RowIDs)
+        {
+            std::string Body{};
+
+            for (const auto RowID : RowIDs)
+            {
+                try
+                {
+                    Backend::Database()
+                        << "SELECT Sender, Messagetype, Timestamp, Signature, Message FROM Messagestream WHERE rowid = ?;" << RowID
+                        >> [&](const std::string &Sender, uint32_t Messagetype, uint64_t Timestamp, const std::vector<char> &Signature, const std::vector<char> &Message)
+                        {
+                            Appenditem(PK, Itemstype, Body, Sender, Messagetype, Timestamp, Signature, Message);
+                        };
+                } catch (...) {}
+            }
+
+            if (!Body.empty()) Sendcontrol(PK, Itemstype, Body);
+        }
+
+        // Stream a whole time-slice to the node, paced by its send-queue so that nothing is dropped.
+        static void Serveslice(const std::string &PK, uint64_t Start, uint64_t End)
+        {
+            uint64_t Lasttimestamp = Start, Count{};
+            int64_t Lastrow = -1;
+            std::string Body{};
+
+            while (true)
+            {
+                size_t Pagesize{};
+                try
+                {
+                    Backend::Database()
+                        << "SELECT rowid, Sender, Messagetype, Timestamp, Signature, Message FROM Messagestream "
+                           "WHERE (Timestamp > ? OR (Timestamp = ? AND rowid > ?)) AND Timestamp < ? ORDER BY Timestamp, rowid LIMIT 256;"
+                        << Lasttimestamp << Lasttimestamp << Lastrow << End
+                        >> [&](int64_t RowID, const std::string &Sender, uint32_t Messagetype, uint64_t Timestamp, const std::vector<char> &Signature, const std::vector<char> &Message)
+                        {
+                            Appenditem(PK, Sliceitemstype, Body, Sender, Messagetype, Timestamp, Signature, Message);
+                            Lasttimestamp = Timestamp; Lastrow = RowID;
+                            Pagesize++; Count++;
+                        };
+                } catch (...) {}
+
+                if (Pagesize == 0) break;
+
+                // Wait for the node to catch up, or give up if it disconnected.
+                while (true)
+                {
+                    const auto Node = getNode(PK);
+                    if (!Node) [[unlikely]] return;
+
+                    std::unique_lock Lock(Node->Sendlock);
+                    if (Node->Queuedbytes < Maxqueuedbytes / 2) break;
+                    Lock.unlock();
+
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+
+            if (!Body.empty()) Sendcontrol(PK, Sliceitemstype, Body);
+
+            const Fetchdone_t Done{ Start, End, Count };
+            Sendcontrol(PK, Fetcheddonetype, { (const char *)&Done, sizeof(Done) });
+        }
+
+        // Ask the node for everything it has in the slice, Timeslices tracks the progress.
+        static void Requestslice(const std::string &PK, uint64_t Start, uint64_t End)
+        {
+            const Fetch_t Request{ Start, End };
+            Sendcontrol(PK, Fetchtype, { (const char *)&Request, sizeof(Request) });
+        }
+
+        // Start the reconciliation from our side, covers the same 24 hours that we keep in the DB.
+        static void Begin(const std::string &PK)
+        {
+            if (Global.Settings.noNetworking || Global.Settings.isPrivate) [[unlikely]] return;
+
+            const auto Start = uint64_t((std::chrono::utc_clock::now() - std::chrono::hours(24)).time_since_epoch().count());
+            const auto End = uint64_t(std::chrono::utc_clock::now().time_since_epoch().count()) + 1;
+            const auto Ranges = Split(Start, End, getEntries(Start, End));
+
+            Sendcontrol(PK, Rangestype, { (const char *)Ranges.data(), Ranges.size() * sizeof(Range_t) });
+        }
+
+        static void onRanges(const std::string &PK, std::string_view Body)
+        {
+            if (Body.size() % sizeof(Range_t)) [[unlikely]] return;
+            const auto Theirs = std::span((const Range_t *)Body.data(), Body.size() / sizeof(Range_t));
+            if (Theirs.empty()) [[unlikely]] return;
+
+            // Fetch the whole span at once rather than per range.
+            uint64_t Low = UINT64_MAX, High = 0;
+            for (const auto &Range : Theirs)
+            {
+                Low = std::min(Low, uint64_t(Range.Start));
+                High = std::max(High, uint64_t(Range.End));
+            }
+            const auto Entries = getEntries(Low, High);
+
+            std::vector<Range_t> Reply{};
+            for (const auto &Range : Theirs)
+            {
+                if (Range.Start >= Range.End) [[unlikely]] continue;
+
+                const auto Ours = getRange(Range.Start, Range.End, Entries);
+                if (Ours.Count == Range.Count && Ours.Fingerprint == Range.Fingerprint) continue;
+
+                // They have nothing here, so skip the ID exchange.
+                if (Range.Count == 0)
+                {
+                    std::vector<int64_t> RowIDs{};
+                    for (const auto &Entry : Entries)
+                        if (Entry.Timestamp >= Range.Start && Entry.Timestamp < Range.End)
+                            RowIDs.push_back(Entry.RowID);
+
+                    sendItems(PK, RowIDs);
+                    continue;
+                }
+
+                // Small enough to just list, or splitting would not help.
+                const auto Listable = Ours.Count <= Leafthreshold || (Range.Count <= Leafthreshold && Ours.Count <= Maxids);
+                if (Listable || Range.End - Range.Start < Splitcount)
+                {
+                    sendIDs(PK, Range.Start, Range.End, false, Entries);
+                    continue;
+                }
+
+                std::ranges::move(Split(Range.Start, Range.End, Entries), std::back_inserter(Reply));
+                if ((Reply.size() + Splitcount) * sizeof(Range_t) > Maxblocksize) [[unlikely]]
+                {
+                    Sendcontrol(PK, Rangestype, { (const char *)Reply.data(), Reply.size() * sizeof(Range_t) });
+                    Reply.clear();
+                }
+            }
+
+            if (!Reply.empty()) Sendcontrol(PK, Rangestype, { (const char *)Reply.data(), Reply.size() * sizeof(Range_t) });
+        }
+        static void onIDs(const std::string &PK, std::string_view Body)
+        {
+            if (Body.size() < sizeof(IDlist_t) || (Body.size() - sizeof(IDlist_t)) % sizeof(uint64_t)) [[unlikely]] return;
+            const auto Header = *(const IDlist_t *)Body.data();
+            Body.remove_prefix(sizeof(IDlist_t));
+
+            Hashset<uint64_t> Theirs{};
+            for (size_t i = 0; i < Body.size(); i += sizeof(uint64_t))
+                Theirs.insert(*(const uint64_t *)(Body.data() + i));
+
+            // Push everything they are missing.
+            const auto Entries = getEntries(Header.Start, Header.End);
+            std::vector<int64_t> Missing{};
+            Hashset<uint64_t> Ours{};
+
+            for (const auto &Entry : Entries)
+            {
+                if (!Theirs.contains(Entry.ID)) Missing.push_back(Entry.RowID);
+                Ours.insert(Entry.ID);
+            }
+            if (!Missing.empty()) sendItems(PK, Missing);
+
+            // And let them know what we are missing.
+            if (!Header.isFinal && std::ranges::any_of(Theirs, [&](uint64_t ID) { return !Ours.contains(ID); }))
+                sendIDs(PK, Header.Start, Header.End, true, Entries);
+        }
+        // Only items sent in reply to a slice request count towards the catch-up progress.
+        static Ingest::Verified_t onItems(const std::string &PK, std::string_view Body, bool isSlice)
+        {
+            using Parsed_t = struct { Item_t Item; std::string_view Signature, Message; std::string Verifieddata; };
+            const auto Currenttime = uint64_t(std::chrono::utc_clock::now().time_since_epoch().count());
+            std::vector<Parsed_t> Parsed{};
+            uint64_t Latest{};
+            size_t Count{};
+
+            while (Body.size() >= sizeof(Item_t))
+            {
+                const auto Item = *(const Item_t *)Body.data();
+                Body.remove_prefix(sizeof(Item_t));
+                if (Body.size() < size_t(Item.Signaturelength) + Item.Messagelength) [[unlikely]] break;
+
+                const auto Signature = Body.substr(0, Item.Signaturelength);
+                const auto Message = Body.substr(Item.Signaturelength, Item.Messagelength);
+                Body.remove_prefix(Signature.size() + Message.size());
+
+                Latest = std::max(Latest, uint64_t(Item.Timestamp));
+                Count++;
+
+                // Same checks as live messages, the peer is only vouching for the link.
+                if (Item.Timestamp > Currenttime) [[unlikely]] continue;
+                auto Data = getVerifieddata(Signature, getSigneddata(Item.Messagetype, Item.Timestamp, Message));
+                if (!Data) [[unlikely]] continue;
+
+                Parsed.push_back({ Item, Signature, Message, std::move(*Data) });
+            }
+
+            // Items tend to come grouped by sender, and batched messages share a signature.
+            std::vector<qDSA::Batchentry_t> Batch{}; Batch.reserve(Parsed.size());
+            for (const auto &Entry : Parsed)
+            {
+                Batch.push_back({ std::span<const uint8_t, 32>(Entry.Item.Sender.data(), 32),
+                                  std::span<const uint8_t, 64>((const uint8_t *)Entry.Signature.data(), 64), Entry.Verifieddata });
+            }
+            const auto isValid = qDSA::Verifybatch(Batch);
+
+            Ingest::Verified_t Result{};
+            for (size_t i = 0; i < Parsed.size(); ++i)
+            {
+                if (!isValid[i]) [[unlikely]] continue;
+                const auto &Entry = Parsed[i];
+
+                Gossip::Seen::Insert(Entry.Item.Sender, *(const std::array<uint8_t, 64> *)Entry.Signature.data());
+                Result.Entries.push_back({ Base58::Encode<char>(Entry.Item.Sender), Entry.Item.Messagetype, Entry.Item.Timestamp, std::string(Entry.Signature), std::string(Entry.Message) });
+            }
+
+            // Progress is reported once the items are persisted.
+            if (isSlice) Result.onStored = [PK, Latest, Count]() { Timeslices::onProgress(PK, Latest, Count); };
+            return Result;
+        }
+        // Slices are served by a few threads from a bounded queue, so peers can't make us spawn threads.
+        namespace Serving
+        {
+            // A slow peer only holds up its own server while the node is paced.
+            constexpr size_t Maxservers = 4, Maxpending = 64;
+
+            using Request_t = struct { std::string PK; uint64_t Start, End; };
+            static std::condition_variable Signal{};
+            static std::deque<Request_t> Pending{};
+            static std::once_flag Initialized{};
+            static std::mutex Lock{};
+
+            [[noreturn]] static void Servethread()
+            {
+                // Name this thread for easier debugging.
+                setThreadname("Ayria_Slices");
+
+                while (true)
+                {
+                    Request_t Request{};
+                    {
+                        std::unique_lock Guard(Lock);
+                        Signal.wait(Guard, [] { return !Pending.empty(); });
+                        Request = std::move(Pending.front());
+                        Pending.pop_front();
+                    }
+
+                    try { Serveslice(Request.PK, Request.Start, Request.End); } catch (...) {}
+                }
+            }
+
+            static void Enqueue(const std::string &PK, uint64_t Start, uint64_t End)
+            {
+                std::call_once(Initialized, []() { for (size_t i = 0; i < Maxservers; ++i) std::thread(Servethread).detach(); });
+
+                {
+                    std::scoped_lock Guard(Lock);
+
+                    // One pending slice per peer, a repeated request replaces the older one.
+                    std::erase_if(Pending, [&](const Request_t &Item) { return Item.PK == PK; });
+                    if (Pending.size() >= Maxpending) [[unlikely]]
+                    {
+                        Warningprint("Messagebus: Too many pending slice requests, dropping one.");
+                        return;
+                    }
+
+                    Pending.emplace_back(PK, Start, End);
+                }
+                Signal.notify_one();
+            }
+        }
+
+        static void onFetch(const std::string &PK, std::string_view Body)
+        {
+            if (Body.size() != sizeof(Fetch_t)) [[unlikely]] return;
+            const auto Request = *(const Fetch_t *)Body.data();
+            if (Global.Settings.isPrivate) [[unlikely]] return;
+
+            // Slices can be large, so don't hold up the persistence thread.
+            Serving::Enqueue(PK, uint64_t(Request.Start), uint64_t(Request.End));
+        }
+        static void onFetchdone(const std::string &PK, std::string_view Body)
+        {
+            if (Body.size() != sizeof(Fetchdone_t)) [[unlikely]] return;
+            const auto Done = *(const Fetchdone_t *)Body.data();
+            Timeslices::onDone(PK, Done.Start, Done.End, Done.Count);
+        }
+
+        // Range and ID exchanges query the DB, so they run on their own thread rather than stalling the persistence.
+        namespace Reconciling
+        {
+            // Peers restart the exchange on their next connection, so shed load rather than growing without bounds.
+            constexpr size_t Maxpending = 256;
+
+            using Request_t = struct { std::string PK; uint32_t Messagetype; std::string Frame; };
+            static std::condition_variable Signal{};
+            static std::queue<Request_t> Pending{};
+            static std::once_flag Initialized{};
+            static std::mutex Lock{};
+
+            [[noreturn]] static void Reconcilethread()
+            {
+                // Name this thread for easier debugging.
+                setThreadname("Ayria_Reconcile");
+
+                while (true)
+                {
+                    Request_t Request{};
+                    {
+                        std::unique_lock Guard(Lock);
+                        Signal.wait(Guard, [] { return !Pending.empty(); });
+                        Request = std::move(Pending.front());
+                        Pending.pop();
+                    }
+
+                    try
+                    {
+                        if (Request.Messagetype == Rangestype) onRanges(Request.PK, Request.Frame);
+                        if (Request.Messagetype == IDstype) onIDs(Request.PK, Request.Frame);
+                    } catch (...) {}
+                }
+            }
+
+            // Called once everything received before the frame is persisted, so the exchange sees it.
+            static void Enqueue(const std::string &PK, uint32_t Messagetype, std::string &&Frame)
+            {
+                std::call_once(Initialized, []() { std::thread(Reconcilethread).detach(); });
+
+                {
+                    std::scoped_lock Guard(Lock);
+                    if (Pending.size() >= Maxpending) [[unlikely]]
+                    {
+                        Warningprint("Messagebus: Reconciliation is falling behind, dropping a request.");
+                        return;
+                    }
+
+                    Pending.push({ PK, Messagetype, std::move(Frame) });
+                }
+                Signal.notify_one();
+            }
+        }
+
+        static bool isControl(uint32_t Messagetype)
+        {
+            return Messagetype == Rangestype || Messagetype == IDstype || Messagetype == Itemstype ||
+                   Messagetype == Sliceitemstype || Messagetype == Fetchtype || Messagetype == Fetcheddonetype;
+        }
+        static void handleControl(const std::string &PK, uint32_t Messagetype, std::string_view Body)
+        {
+            // Items are verified on the worker-pool, the rest are ordered after the persistence and handed off from there.
+            Ingest::Enqueue([PK, Messagetype, Frame = std::string(Body)]() -> Ingest::Verified_t
+            {
+                if (Messagetype == Itemstype || Messagetype == Sliceitemstype) return onItems(PK, Frame, Messagetype == Sliceitemstype);
+
+                return { {}, [=]() mutable
+                {
+                    if (Messagetype == Rangestype || Messagetype == IDstype) Reconciling::Enqueue(PK, Messagetype, std::move(Frame));
+                    if (Messagetype == Fetchtype) onFetch(PK, Frame);
+                    if (Messagetype == Fetcheddonetype) onFetchdone(PK, Frame);
+                } };
+            }, false);
+        }
+    }
+
+    // Catch up on what we missed while offline by splitting the time between the relays.
+    namespace Timeslices
+    {
+        using Slice_t = struct { std::string Relay; uint64_t Start, End, Latest; size_t Received; bool isDone; };
+        static std::chrono::steady_clock::time_point Started{};
+        static std::vector<Slice_t> Slices{};
+        static Spinlock Progresslock{};
+
+        static void onProgress(const std::string &Relay, uint64_t Latest, size_t Count)
+        {
+            std::scoped_lock Lock(Progresslock);
+            for (auto &Slice : Slices)
+            {
+                if (Slice.Relay != Relay || Slice.isDone) continue;
+                Slice.Latest = std::max(Slice.Latest, Latest);
+                Slice.Received += Count;
+            }
+        }
+        static void onDone(const std::string &Relay, uint64_t Start, uint64_t End, size_t Count)
+        {
+            std::scoped_lock Lock(Progresslock);
+            for (auto &Slice : Slices)
+            {
+                if (Slice.Relay != Relay || Slice.Start != Start || Slice.End != End) continue;
+                Slice.Latest = End;
+                Slice.isDone = true;
+
+                if (Slice.Received != Count) [[unlikely]]
+                    Warningprint(va("Catchup: Relay %s sent %zu of %zu messages.", Relay.c_str(), Slice.Received, Count));
+            }
+
+            if (std::ranges::all_of(Slices, &Slice_t::isDone))
+            {
+                const auto Duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Started);
+                Infoprint(va("Catchup: Done with %zu relays in %lli ms.", Slices.size(), Duration.count()));
+            }
+        }
+
+        // Let the user see how far along we are.
+        static std::string __cdecl getProgress(JSON::Value_t &&)
+        {
+            JSON::Array_t Result{};
+
+            std::scoped_lock Lock(Progresslock);
+            for (const auto &Slice : Slices)
+            {
+                const auto Span = double(Slice.End - Slice.Start);
+                const auto Covered = double(std::clamp(Slice.Latest, Slice.Start, Slice.End) - Slice.Start);
+
+                Result.emplace_back(JSON::Object_t({
+                    { "Progress", Slice.isDone ? 1.0 : Covered / Span },
+                    { "Received", Slice.Received },
+                    { "isDone", Slice.isDone },
+                    { "Relay", Slice.Relay },
+                    { "Start", Slice.Start },
+                    { "End", Slice.End }
+                }));
+            }
+
+            return JSON::Dump(Result);
+        }
+
+        static void Start(std::vector<std::pair<uint32_t, uint16_t>> &&Relays)
+        {
+            // Connect to all relays in parallel, the ones that fail are not given a slice.
+            std::vector<std::future<std::pair<std::string, bool>>> Pending{};
+            for (const auto &[IPv4, Port] : Relays)
+                Pending.push_back(std::async(std::launch::async, Connectnode, IPv4, Port));
+
+            std::vector<std::string> Connected{};
+            for (auto &Future : Pending)
+                if (auto [PK, isNew] = Future.get(); !PK.empty())
+                    Connected.push_back(std::move(PK));
+
+            if (Connected.empty()) [[unlikely]]
+            {
+                Warningprint("Catchup: Could not connect to any relay.");
+                return;
+            }
+
+            // Everything since our last message, but no further back than what the relays keep.
+            const auto Now = uint64_t(std::chrono::utc_clock::now().time_since_epoch().count());
+            auto Start = uint64_t((std::chrono::utc_clock::now() - std::chrono::hours(24)).time_since_epoch().count());
+            try { Backend::Database() << "SELECT IFNULL(MAX(Timestamp), 0) FROM Messagestream;" >> [&](uint64_t Last) { Start = std::max(Start, Last); }; } catch (...) {}
+
+            const auto End = Now + 1;
+            const auto Step = std::max((End - Start) / Connected.size(), uint64_t(1));
+
+            {
+                std::scoped_lock Lock(Progresslock);
+                Started = std::chrono::steady_clock::now();
+                Slices.clear();
+
+                for (const auto &[Index, PK] : lz::enumerate(Connected))
+                {
+                    const auto Slicestart = Start + Index * Step;
+                    const auto Sliceend = (size_t(Index) + 1 == Connected.size()) ? End : Slicestart + Step;
+                    if (Slicestart >= End) break;
+
+                    Slices.emplace_back(PK, Slicestart, Sliceend, Slicestart, 0, false);
+                }
+            }
+
+            Infoprint(va("Catchup: Requesting %zu slices from %zu relays.", Slices.size(), Connected.size()));
+            for (const auto &Slice : Slices) Sync::Requestslice(Slice.Relay, Slice.Start, Slice.End);
+        }
+    }
+
+    // Fetch what we missed from the relays in parallel, host order.
+    void Catchup(std::vector<std::pair<uint32_t, uint16_t>> Relays)
+    {
+        if (Relays.empty() || Global.Settings.noNetworking) return;
+        std::thread(Timeslices::Start, std::move(Relays)).detach();
+    }
+
+    // Read everything the node has sent and process all complete frames, returns false if the connection is dead.
+    static bool Drainsocket(const std::string &PK, Node_t &Node)
+    {
+        while (true)
+        {
+            const auto Writable = Node.Receivebuffer.Writable();
+            const auto Return = recv(Node.Socket, Writable.data(), int(Writable.size()), NULL);
+
+            if (Return == 0) [[unlikely]] return false;
+            if (Return == SOCKET_ERROR) return WSAGetLastError() == WSAEWOULDBLOCK;
+            Node.Receivebuffer.Commit(Return);
+
+            while (const auto Frame = Node.Receivebuffer.Nextframe())
+            {
+                // A malformed or corrupted frame desyncs the stream, so the link can't be used anymore.
+                if (Frame->size() <= sizeof(Packet_t)) [[unlikely]] return false;
+                const auto Payload = Node.Decoder.Decompress(Frame->substr(sizeof(Packet_t)));
+                if (!Payload) [[unlikely]] return false;
+
+                const auto Header = reinterpret_cast<const Packet_t *>(Frame->data());
+                if (Sync::isControl(Header->Payload.Messagetype)) [[unlikely]] Sync::handleControl(PK, Header->Payload.Messagetype, *Payload);
+                else handleMessage(PK, Header, *Payload);
+            }
+            Node.Receivebuffer.Reset();
+
+            // Kernel buffer is drained.
+            if (Return < static_cast<int>(Writable.size())) return true;
+        }
+    }
+
+    // Runs until the application terminates, blocks until there's work.
+    [[noreturn]] static void Networkthread()
+    {
+        // Name this thread for easier debugging.
+        setThreadname("Ayria_Network");
+
+        while (true)
+        {
+            // The timeout is only so that WSAPoll notices new nodes, epoll sees them instantly.
+            for (const auto Socket : Poller::Wait(50))
+            {
+                if (Socket == Listensocket) [[unlikely]]
+                {
+                    Acceptconnections();
+                    continue;
+                }
+
+                std::string PK{};
+                std::shared_ptr<Node_t> Node{};
+                {
+                    std::scoped_lock Lock(Threadsafe);
+                    if (!Nodesockets.contains(Socket)) [[unlikely]] continue;
+                    PK = Nodesockets[Socket];
+                    Node = Connectednodes[PK];
+                }
+
+                if (!Drainsocket(PK, *Node)) [[unlikely]]
+                    Erasenode(Socket);
+            }
+        }
+    }
+
+    // Let the user see how well the nodes keep up.
+    static std::string __cdecl getNodestats(JSON::Value_t &&)
+    {
+        JSON::Array_t Result{};
+
+        std::scoped_lock Lock(Threadsafe);
+        for (const auto &[PK, Node] : Connectednodes)
+        {
+            std::scoped_lock Sendguard(Node->Sendlock);
+            Result.emplace_back(JSON::Object_t({
+                { "Droppedframes", Node->Droppedframes },
+                { "Queuedframes", Node->Sendqueue.size() },
+                { "Queuedbytes", Node->Queuedbytes },
+                { "Sentbytes", Node->Sentbytes },
+                { "Uncompressedbytes", Node->Uncompressedbytes },
+                { "LongID", PK }
+            }));
+        }
+
+        return JSON::Dump(Result);
+    }
+
+    void Initialize(bool doLANDiscovery, uint16_t Port)
+    {
+        Layer3::addEndpoint("Messagebus::getNodestats", getNodestats);
+        Layer3::addEndpoint("Messagebus::getCatchup", Timeslices::getProgress);
+
+        do
+        {
+            // WSAPoll needs WS 2.2.
+            WSADATA Unused;
+            (void)WSAStartup(MAKEWORD(2, 2), &Unused);
+
+            Listensocket = socket(AF_INET, SOCK_STREAM, 0);
+            if (Listensocket == INVALID_SOCKET) break;
+
+            int Argument{ 0 }; // Enable Nagles algorithm.
             if (SOCKET_ERROR == setsockopt(Listensocket, IPPROTO_TCP, TCP_NODELAY, (char *)&Argument, sizeof(Argument))) [[unlikely]]
                 break;
 
@@ -342,26 +1835,46 @@ namespace Backend::Messagebus
             if (SOCKET_ERROR == setsockopt(Listensocket, SOL_SOCKET, SO_KEEPALIVE, (char *)&Argument, sizeof(Argument))) [[unlikely]]
                 break;
 
-            // Bind to a random port.
-            const sockaddr_in Localhost{ AF_INET, 0, {{.S_addr = htonl(INADDR_ANY)}} };
+            // Fixed ports are used by relays that may restart, don't wait for TIME_WAIT.
+            if (Port && SOCKET_ERROR == setsockopt(Listensocket, SOL_SOCKET, SO_REUSEADDR, (char *)&Argument, sizeof(Argument))) [[unlikely]]
+                break;
+
+            // Bind to the requested port, or a random one.
+            const sockaddr_in Localhost = Makeaddress(htonl(INADDR_ANY), htons(Port));
             if (SOCKET_ERROR == bind(Listensocket, PSOCKADDR(&Localhost), sizeof(Localhost))) [[unlikely]]
                 break;
 
             // As a client, we shouldn't have too many incoming connections.
-            if (SOCKET_ERROR == listen(Listensocket, 5)) [[unlikely]]
+            if (SOCKET_ERROR == listen(Listensocket, Gossip::isRelay ? SOMAXCONN : 5)) [[unlikely]]
                 break;
 
             // Fetch the random port we are bound to.
-            sockaddr_in Sockinfo{}; int Len = sizeof(Sockinfo);
+            sockaddr_in Sockinfo{}; socklen_t Len = sizeof(Sockinfo);
             if (SOCKET_ERROR == getsockname(Listensocket, PSOCKADDR(&Sockinfo), &Len)) [[unlikely]]
                 break;
 
-            // Should only need to check for packets 5 times a second.
-            Backend::Enqueuetask(200, doNetworking);
+            // Incoming connections are accepted from the network thread.
+            unsigned long Nonblocking{ 1 };
+            if (SOCKET_ERROR == ioctlsocket(Listensocket, FIONBIO, &Nonblocking)) [[unlikely]]
+                break;
+
+            if (!Poller::Initialize() || !Sender::Initialize()) [[unlikely]]
+                break;
+
+            Poller::Insert(Listensocket);
+            Ingest::Initialize();
+            std::thread(Networkthread).detach();
+            std::thread(Sender::Senderthread).detach();
             Global.Settings.noNetworking = false;
             Listenport = Sockinfo.sin_port;
+            Infoprint(va("Messagebus: Listening on port %u.", ntohs(Listenport)));
+
+            // Batches are flushed when full or at the latest on the next tick.
+            Backend::Enqueuetask(100, Batching::Flush);
+            std::atexit(Batching::Flush);
 
             if (doLANDiscovery) LANDiscovery::Initialize();
+            return;
         } while (false);
 
         Global.Settings.noNetworking = true;
@@ -390,7 +1903,7 @@ namespace Backend::Messagebus
                 return;
             }
 
-            Connectuser(inet_addr(IPv4), htons(std::atoi(Port)));
+            Connectuser(ntohl(inet_addr(IPv4)), uint16_t(std::atoi(Port)));
         }
     }
 }
@@ -9,61 +9,860 @@
 namespace Backend::Messageprocessing
 {
     static Hashmap<uint32_t, Hashset<Callback_t>> Messagehandlers{};
+    static Hashmap<uint32_t, Hashset<Parsedcallback_t>> Parsedhandlers{};
+
+    // Handlers with state shared between senders (e.g. caches) run one at a time.
+    static Hashset<Parsedcallback_t> Sharedparsed{};
+    static Hashset<Callback_t> Sharedhandlers{};
+    static std::mutex Sharedlock{};
+
+    // Plugins are not required to be thread-safe, so they get the batch in order on the processing thread.
+    static Hashmap<uint32_t, Hashset<Callback_t>> Pluginhandlers{};
+
+    // Plugins can subscribe at any time, so the handlers, policies, and names are read under a shared lock.
+    static std::shared_mutex Registrylock{};
+
+    // Batches, compaction, and rebuilds each own the transaction on the shared connection.
+    static std::mutex Dispatchlock{};
+
+    // Counters for tuning the processing, merged once per batch so that handlers don't contend.
+    namespace Stats
+    {
+        using Counters_t = struct { uint64_t Received, Processed, Rejected, Handlertime; };
+
+        // Receipt to handler completion, bucket N covers [2^(N-1), 2^N) milliseconds.
+        constexpr size_t Bucketcount = 20;
+        using Histogram_t = std::array<uint64_t, Bucketcount>;
+
+        static Hashmap<uint32_t, std::string> Typenames{};
+        static Hashmap<uint32_t, Counters_t> Counters{};
+        static std::atomic<size_t> Backlog{};
+        static Histogram_t Latency{};
+        static std::mutex Statslock{};
+
+        static size_t getBucket(std::chrono::steady_clock::duration Duration)
+        {
+            const auto Milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(Duration).count();
+
+            size_t Bucket = 0;
+            while (Bucket < Bucketcount - 1 && (Milliseconds >> Bucket) > 0) ++Bucket;
+            return Bucket;
+        }
+
+        // Upper bound in milliseconds of the bucket containing the percentile.
+        static uint64_t getPercentile(const Histogram_t &Histogram, double Percentile)
+        {
+            uint64_t Total{}, Seen{};
+            for (const auto &Count : Histogram) Total += Count;
+
+            for (size_t i = 0; i < Bucketcount; ++i)
+            {
+                Seen += Histogram[i];
+                if (Total && Seen >= Total * Percentile) return uint64_t(1) << i;
+            }
+
+            return 0;
+        }
+
+        static void onReceived(const std::vector<Message_t> &Messages)
+        {
+            Backlog += Messages.size();
+
+            std::scoped_lock Lock(Statslock);
+            for (const auto &Message : Messages) Counters[Message.Messagetype].Received++;
+        }
+        static void onProcessed(const Hashmap<uint32_t, Counters_t> &Delta, const Histogram_t &Histogram)
+        {
+            std::scoped_lock Lock(Statslock);
+            for (const auto &[Messagetype, Counter] : Delta)
+            {
+                auto &Entry = Counters[Messagetype];
+                Entry.Processed += Counter.Processed;
+                Entry.Rejected += Counter.Rejected;
+                Entry.Handlertime += Counter.Handlertime;
+            }
+
+            for (size_t i = 0; i < Bucketcount; ++i) Latency[i] += Histogram[i];
+        }
+
+        static std::string getName(uint32_t Messagetype)
+        {
+            std::shared_lock Lock(Registrylock);
+            if (const auto Name = Typenames.find(Messagetype); Name != Typenames.end()) return Name->second;
+            return va("0x%08X", Messagetype);
+        }
+
+        // Processing merges counters with the Registrylock held, so names are resolved after the Statslock is released.
+        static std::pair<Hashmap<uint32_t, Counters_t>, Histogram_t> getSnapshot()
+        {
+            std::scoped_lock Lock(Statslock);
+            return { Counters, Latency };
+        }
+
+        // Layer 3 interaction.
+        static std::string __cdecl getStats(JSON::Value_t &&)
+        {
+            JSON::Array_t Types{}, Histogram{};
+
+            const auto [Current, Histogramcopy] = getSnapshot();
+            for (const auto &[Messagetype, Counter] : Current)
+            {
+                const auto Handled = Counter.Processed + Counter.Rejected;
+                Types.emplace_back(JSON::Object_t({
+                    { "Averagetime", Handled ? double(Counter.Handlertime) / Handled / 1000.0 : 0.0 },
+                    { "Handlertime", Counter.Handlertime / 1000 },
+                    { "Processed", Counter.Processed },
+                    { "Received", Counter.Received },
+                    { "Rejected", Counter.Rejected },
+                    { "Messagetype", getName(Messagetype) }
+                }));
+            }
+            for (const auto &Count : Histogramcopy) Histogram.emplace_back(Count);
+
+            return JSON::Dump(JSON::Object_t({
+                { "P50", getPercentile(Histogramcopy, 0.50) },
+                { "P99", getPercentile(Histogramcopy, 0.99) },
+                { "Backlog", Backlog.load() },
+                { "Latency", Histogram },
+                { "Types", Types }
+            }));
+        }
+
+        // Usage: Messageprocessing::Stats, times are in microseconds unless noted.
+        static void __cdecl Printstats(int, const char **)
+        {
+            const auto [Current, Histogramcopy] = getSnapshot();
+
+            Infoprint(va("Messageprocessing: Backlog %zu, receipt to completion P50 < %llu ms, P99 < %llu ms.",
+                         Backlog.load(), getPercentile(Histogramcopy, 0.50), getPercentile(Histogramcopy, 0.99)));
+
+            for (const auto &[Messagetype, Counter] : Current)
+            {
+                const auto Handled = Counter.Processed + Counter.Rejected;
+                Infoprint(va("%s: %llu received, %llu processed, %llu rejected, %.1f us per message.",
+                             getName(Messagetype).c_str(), Counter.Received, Counter.Processed, Counter.Rejected,
+                             Handled ? double(Counter.Handlertime) / Handled / 1000.0 : 0.0));
+            }
+        }
+    }
 
     // Listen for packets of a certain type.
-    void addMessagehandler(std::string_view Identifier, Callback_t Handler)
+    void addMessagehandler(std::string_view Identifier, Callback_t Handler, bool isShared)
     {
-        if (Handler) [[likely]] Messagehandlers[Hash::WW32(Identifier)].insert(Handler);
+        if (!Handler) [[unlikely]] return;
+
+        std::unique_lock Lock(Registrylock);
+        Messagehandlers[Hash::WW32(Identifier)].insert(Handler);
+        Stats::Typenames.emplace(Hash::WW32(Identifier), Identifier);
+        if (isShared) Sharedhandlers.insert(Handler);
     }
+    void addMessagehandler(std::string_view Identifier, Parsedcallback_t Handler, bool isShared)
+    {
+        if (!Handler) [[unlikely]] return;
 
-    //
-    static void __cdecl doProcess()
+        std::unique_lock Lock(Registrylock);
+        Parsedhandlers[Hash::WW32(Identifier)].insert(Handler);
+        Stats::Typenames.emplace(Hash::WW32(Identifier), Identifier);
+        if (isShared) Sharedparsed.insert(Handler);
+    }
+    static void addPluginhandler(std::string_view Identifier, Callback_t Handler)
     {
-        // Only processed if the queries succeed.
-        Hashset<int64_t> Processed{}, Invalid{};
+        std::unique_lock Lock(Registrylock);
+        Pluginhandlers[Hash::WW32(Identifier)].insert(Handler);
+        Stats::Typenames.emplace(Hash::WW32(Identifier), Identifier);
+    }
 
-        try
+    // Incremental removal of superseded messages, so that the stream tracks live state rather than history.
+    namespace Compaction
+    {
+        static Hashmap<uint32_t, Compactionkey_t> Policies{};
+        static int64_t Cursor{};
+
+        // Rows scanned and deleted per tick, to keep the DB responsive.
+        constexpr int Scanlimit = 512; constexpr size_t Deletelimit = 256;
+
+        // SQLite allows 32766 variables per statement.
+        constexpr size_t Chunksize = 4096;
+
+        // Without a key-function the message replaces everything of its type from the sender.
+        static std::string getKey(Compactionkey_t Keyfunction, std::string_view Message)
         {
-            // Poll for unprocessed packets.
-            Backend::Database()
-                << "SELECT (rowid, Messagetype, Timestamp, Message, Sender) FROM Messagestream WHERE (isProcessed = false) ORDER BY Timestamp LIMIT 10;"
-                >> [&](int64_t rowid, uint32_t Messagetype, uint64_t Timestamp, const std::string &Message, const std::string &Sender)
+            if (!Keyfunction) return {};
+            return Keyfunction(Message.data(), static_cast<uint32_t>(Message.size()));
+        }
+
+        // Sender, type, and key in one lookup, Base58 senders never contain the separator.
+        static std::string getGroup(std::string_view Sender, uint32_t Messagetype, std::string_view Key)
+        {
+            std::string Result(Sender);
+            Result.append(va(":%08X:", Messagetype));
+            Result.append(Key);
+            return Result;
+        }
+
+        // Messages in the batch for which a newer message with the same key has already been processed.
+        static Hashset<const Message_t *> getSuperseded(const std::vector<Message_t> &Messages)
+        {
+            // Only the oldest message per (Sender, Messagetype) bounds the query.
+            Hashmap<std::string, std::tuple<std::string_view, uint32_t, uint64_t>> Groups{};
+            for (const auto &Message : Messages)
+            {
+                if (!Policies.contains(Message.Messagetype)) [[likely]] continue;
+
+                const auto [Entry, isNew] = Groups.try_emplace(getGroup(Message.Sender, Message.Messagetype, {}), Message.Sender, Message.Messagetype, Message.Timestamp);
+                if (!isNew) std::get<2>(Entry->second) = std::min(std::get<2>(Entry->second), Message.Timestamp);
+            }
+            if (Groups.empty()) [[likely]] return {};
+
+            std::vector<std::tuple<std::string_view, uint32_t, uint64_t>> Pending{};
+            Pending.reserve(Groups.size());
+            for (const auto &[_, Group] : Groups) Pending.push_back(Group);
+
+            // Newest processed timestamp per (Sender, Messagetype, Key).
+            Hashmap<std::string, uint64_t> Newest{};
+
+            try
+            {
+                for (size_t Offset = 0; Offset < Pending.size(); Offset += Chunksize)
                 {
-                    const auto Decoded = Base85::Decode(Message);
-                    Processed.insert(rowid);
+                    const auto Count = std::min(Chunksize, Pending.size() - Offset);
+
+                    std::string SQL("WITH Batch(Sender, Messagetype, Since) AS (VALUES (?,?,?)");
+                    for (size_t i = 1; i < Count; ++i) SQL.append(",(?,?,?)");
+                    SQL.append(") SELECT Messagestream.Sender, Messagestream.Messagetype, Messagestream.Timestamp, Messagestream.Message FROM Messagestream "
+                               "JOIN Batch ON (Messagestream.Sender = Batch.Sender AND Messagestream.Messagetype = Batch.Messagetype AND Messagestream.Timestamp > Batch.Since) "
+                               "WHERE (Messagestream.isProcessed = true);");
 
-                    std::ranges::for_each(Messagehandlers[Messagetype], [&](const auto &CB)
+                    auto Statement = Backend::Database() << SQL;
+                    for (size_t i = Offset; i < Offset + Count; ++i)
+                        Statement << std::string(std::get<0>(Pending[i])) << std::get<1>(Pending[i]) << std::get<2>(Pending[i]);
+
+                    Statement >> [&](std::string &&Sender, uint32_t Messagetype, uint64_t Timestamp, const std::vector<char> &Message)
                     {
-                        if (!CB(Timestamp, Sender.c_str(), Decoded.data(), static_cast<uint32_t>(Decoded.size())))
-                            Invalid.insert(rowid);
-                    });
-                };
+                        auto &Entry = Newest[getGroup(Sender, Messagetype, getKey(Policies[Messagetype], { Message.data(), Message.size() }))];
+                        Entry = std::max(Entry, Timestamp);
+                    };
+                }
+            } catch (...) {}
+
+            Hashset<const Message_t *> Result{};
+            if (Newest.empty()) [[likely]] return Result;
 
-            // Remove any invalid messages.
-            for (const auto &Row : Invalid)
+            for (const auto &Message : Messages)
             {
-                Processed.erase(Row);
-                Backend::Database()
-                    << "DELETE FROM Messagestream WHERE rowid = ?;"
-                    << Row;
+                const auto Policy = Policies.find(Message.Messagetype);
+                if (Policy == Policies.end()) [[likely]] continue;
+
+                const auto Entry = Newest.find(getGroup(Message.Sender, Message.Messagetype, getKey(Policy->second, Message.Message)));
+                if (Entry != Newest.end() && Entry->second > Message.Timestamp) Result.insert(&Message);
             }
 
-            // Update the status.
-            for (const auto &Row : Processed)
+            return Result;
+        }
+
+        static void __cdecl doCompact()
+        {
+            // Try again next tick rather than stalling the task thread.
+            std::unique_lock Lock(Dispatchlock, std::try_to_lock);
+            if (!Lock) return;
+
+            std::shared_lock Registry(Registrylock);
+            if (Policies.empty()) [[unlikely]] return;
+
+            std::set<std::pair<std::string, uint32_t>> Candidates{};
+            std::vector<int64_t> Superseded{};
+            int64_t Lastrow = Cursor;
+
+            try
             {
+                // Collect the (Sender, Messagetype) groups from the next slice of the stream.
                 Backend::Database()
-                    << "UPDATE Messagestream SET isProcessed = true WHERE rowid = ?;"
-                    << Row;
+                    << "SELECT rowid, Sender, Messagetype FROM Messagestream WHERE (rowid > ? AND isProcessed = true) ORDER BY rowid LIMIT ?;"
+                    << Cursor << Scanlimit
+                    >> [&](int64_t rowid, std::string &&Sender, uint32_t Messagetype)
+                    {
+                        Lastrow = rowid;
+                        if (Policies.contains(Messagetype)) Candidates.emplace(std::move(Sender), Messagetype);
+                    };
+
+                // Start over once we reach the end of the stream.
+                Cursor = (Lastrow == Cursor) ? 0 : Lastrow;
+
+                for (const auto &[Sender, Messagetype] : Candidates)
+                {
+                    const auto Keyfunction = Policies[Messagetype];
+                    Hashmap<std::string, std::pair<uint64_t, int64_t>> Latest{};
+                    std::vector<std::tuple<int64_t, std::string, bool>> Rows{};
+
+                    // Unprocessed rows can still supersede, but they are never removed.
+                    Backend::Database()
+                        << "SELECT rowid, Timestamp, Message, isProcessed FROM Messagestream WHERE (Sender = ? AND Messagetype = ?);"
+                        << Sender << Messagetype
+                        >> [&](int64_t rowid, uint64_t Timestamp, const std::vector<char> &Message, bool isProcessed)
+                        {
+                            auto Key = getKey(Keyfunction, { Message.data(), Message.size() });
+                            auto &Entry = Latest[Key];
+                            Entry = std::max(Entry, std::make_pair(Timestamp, rowid));
+
+                            Rows.emplace_back(rowid, std::move(Key), isProcessed);
+                        };
+
+                    for (const auto &[rowid, Key, isProcessed] : Rows)
+                    {
+                        if (isProcessed && Latest[Key].second != rowid)
+                            Superseded.push_back(rowid);
+                    }
+
+                    if (Superseded.size() >= Deletelimit) break;
+                }
+
+                if (Superseded.empty()) return;
+
+                // Outside the lock the deletes would land in whichever transaction Layer 1 has open.
+                std::scoped_lock Transaction(Backend::Transactionlock());
+
+                // One statement per chunk, a partial pass is picked up again next tick.
+                for (size_t Offset = 0; Offset < Superseded.size(); Offset += Chunksize)
+                {
+                    const auto Count = std::min(Chunksize, Superseded.size() - Offset);
+
+                    std::string SQL("DELETE FROM Messagestream WHERE rowid IN (?");
+                    for (size_t i = 1; i < Count; ++i) SQL.append(",?");
+                    SQL.append(");");
+
+                    auto Statement = Backend::Database() << SQL;
+                    for (size_t i = Offset; i < Offset + Count; ++i) Statement << Superseded[i];
+                    Statement.execute();
+                }
+
+                Debugprint(va("Messagestream: Compacted %zu superseded messages.", Superseded.size()));
+            } catch (...) {}
+        }
+    }
+
+    // Last-writer-wins types only need the newest message per (Sender, Key), older ones get compacted.
+    void addCompactionpolicy(std::string_view Identifier, Compactionkey_t Keyfunction)
+    {
+        std::unique_lock Lock(Registrylock);
+        Compaction::Policies[Hash::WW32(Identifier)] = Keyfunction;
+    }
+
+    // Multiple producers (Layer 1 threads and our own publishing), one consumer.
+    namespace Channel
+    {
+        // A batch is one transaction, so a catch-up backlog should not hold the connection for its whole length.
+        constexpr size_t Maxbatchsize = 1024;
+
+        static std::mutex Channellock{};
+        static std::condition_variable Signal{};
+        static std::deque<Message_t> Pending{};
+
+        static void Push(std::vector<Message_t> &&Messages)
+        {
+            {
+                std::scoped_lock Lock(Channellock);
+                std::ranges::move(Messages, std::back_inserter(Pending));
+            }
+            Signal.notify_one();
+        }
+        static std::vector<Message_t> Take()
+        {
+            std::unique_lock Lock(Channellock);
+            Signal.wait(Lock, [] { return !Pending.empty(); });
+
+            const auto Count = std::min(Maxbatchsize, Pending.size());
+            std::vector<Message_t> Result(std::make_move_iterator(Pending.begin()), std::make_move_iterator(Pending.begin() + Count));
+            Pending.erase(Pending.begin(), Pending.begin() + Count);
+            return Result;
+        }
+    }
+
+    void Enqueue(std::vector<Message_t> &&Messages)
+    {
+        if (Messages.empty()) [[unlikely]] return;
+
+        Stats::onReceived(Messages);
+        Channel::Push(std::move(Messages));
+    }
+
+    // Handlers run inside the batch transaction, so preparing the statement is the remaining per-message cost.
+    sqlite::database_binder &getStatement(std::string_view SQL)
+    {
+        thread_local Hashmap<uint64_t, std::unique_ptr<sqlite::database_binder>> Statements{};
+
+        auto &Entry = Statements[Hash::WW64(SQL)];
+        if (!Entry) [[unlikely]]
+        {
+            Entry = std::make_unique<sqlite::database_binder>(Backend::Database() << std::string(SQL));
+
+            // Unused binders execute on destruction, which we don't want for a cache.
+            Entry->used(true);
+        }
+
+        return *Entry;
+    }
+
+    // Rows are identified by their unique (Sender, Signature) as we never see the rowid, one statement per chunk.
+    static void Updaterows(std::string_view Operation, const std::vector<const Message_t *> &Messages)
+    {
+        // SQLite allows 32766 variables per statement.
+        constexpr size_t Chunksize = 4096;
+
+        for (size_t Offset = 0; Offset < Messages.size(); Offset += Chunksize)
+        {
+            const auto Count = std::min(Chunksize, Messages.size() - Offset);
+
+            std::string SQL(Operation);
+            SQL.append(" WHERE (Sender, Signature) IN (VALUES (?,?)");
+            for (size_t i = 1; i < Count; ++i) SQL.append(",(?,?)");
+            SQL.append(");");
+
+            auto Statement = Backend::Database() << SQL;
+            for (size_t i = Offset; i < Offset + Count; ++i)
+                Statement << Messages[i]->Sender << std::vector<char>(Messages[i]->Signature.begin(), Messages[i]->Signature.end());
+            Statement.execute();
+        }
+    }
+
+    // Called with the Registrylock held, from any of the partition workers.
+    static bool Process(const Message_t &Message)
+    {
+        bool isValid = true;
+
+        // Internal handlers that want the raw message.
+        if (const auto Handlers = Messagehandlers.find(Message.Messagetype); Handlers != Messagehandlers.end())
+        {
+            for (const auto &Callback : Handlers->second)
+            {
+                std::unique_lock Lock(Sharedlock, std::defer_lock);
+                if (Sharedhandlers.contains(Callback)) Lock.lock();
+
+                isValid &= Callback(Message.Timestamp, Message.Sender.c_str(), Message.Message.data(), static_cast<uint32_t>(Message.Message.size()));
             }
+        }
+
+        // Internal handlers share a single parse of the message.
+        if (const auto Handlers = Parsedhandlers.find(Message.Messagetype); Handlers != Parsedhandlers.end())
+        {
+            JSON::Value_t Parsed{};
+            try { Parsed = JSON::Parse(Message.Message); }
+            catch (...) { return false; }
 
+            for (const auto &Callback : Handlers->second)
+            {
+                std::unique_lock Lock(Sharedlock, std::defer_lock);
+                if (Sharedparsed.contains(Callback)) Lock.lock();
+
+                isValid &= Callback(Message.Timestamp, Message.Sender.c_str(), Parsed);
+            }
+        }
+
+        return isValid;
+    }
+
+    // Plugins get the raw message over the C ABI, on the processing thread.
+    static bool Processplugins(const Message_t &Message)
+    {
+        bool isValid = true;
+
+        if (const auto Handlers = Pluginhandlers.find(Message.Messagetype); Handlers != Pluginhandlers.end())
+            for (const auto &Callback : Handlers->second)
+                isValid &= Callback(Message.Timestamp, Message.Sender.c_str(), Message.Message.data(), static_cast<uint32_t>(Message.Message.size()));
+
+        return isValid;
+    }
+
+    // Handlers only rely on the order within a sender, so senders are hashed onto a fixed set of workers.
+    namespace Partitions
+    {
+        // Small batches are not worth the hand-off.
+        constexpr size_t Parallelthreshold = 64;
+
+        struct Partition_t
+        {
+            std::vector<const Message_t *> Pending;
+            Hashmap<uint32_t, uint64_t> Handlertime;
+            Stats::Histogram_t Latency;
+        };
+        static std::vector<Partition_t> Partitions{};
+
+        // The batch being processed, results are indexed like the messages.
+        static const Hashset<const Message_t *> *Superseded{};
+        static const Message_t *Firstmessage{};
+        static std::vector<uint8_t> Results{};
+
+        static std::mutex Workerlock{};
+        static std::condition_variable Startsignal{}, Donesignal{};
+        static size_t Generation{}, Remaining{};
+
+        static void Run(Partition_t &Partition)
+        {
+            for (const auto Message : Partition.Pending)
+            {
+                const auto Start = std::chrono::steady_clock::now();
+                Results[Message - Firstmessage] = Superseded->contains(Message) || Process(*Message);
+                const auto End = std::chrono::steady_clock::now();
+
+                Partition.Handlertime[Message->Messagetype] += std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count();
+                if (Message->Received != std::chrono::steady_clock::time_point{}) [[likely]]
+                    Partition.Latency[Stats::getBucket(End - Message->Received)]++;
+            }
+        }
+
+        [[noreturn]] static void Workerthread(size_t Index)
+        {
+            // Name this thread for easier debugging.
+            setThreadname("Ayria_Partition");
+
+            // The processing thread holds the transaction until all partitions are done.
+            Notifications::Defer(true);
+
+            size_t Lastgeneration{};
+            while (true)
+            {
+                {
+                    std::unique_lock Lock(Workerlock);
+                    Startsignal.wait(Lock, [&] { return Generation != Lastgeneration; });
+                    Lastgeneration = Generation;
+                }
+
+                Run(Partitions[Index]);
+
+                std::scoped_lock Lock(Workerlock);
+                if (--Remaining == 0) Donesignal.notify_one();
+            }
+        }
+
+        // Called from the processing thread with the Registrylock held, returns when the whole batch is done.
+        static void Processbatch(const std::vector<Message_t> &Messages, const Hashset<const Message_t *> &Supersededset)
+        {
+            for (auto &Partition : Partitions)
+            {
+                Partition.Pending.clear();
+                Partition.Handlertime.clear();
+                Partition.Latency = {};
+            }
+
+            Superseded = &Supersededset;
+            Firstmessage = Messages.data();
+            Results.assign(Messages.size(), false);
+
+            for (const auto &Message : Messages)
+                Partitions[Hash::WW64(Message.Sender) % Partitions.size()].Pending.push_back(&Message);
+
+            if (Partitions.size() == 1 || Messages.size() < Parallelthreshold)
+            {
+                for (auto &Partition : Partitions) Run(Partition);
+                return;
+            }
+
+            std::unique_lock Lock(Workerlock);
+            Remaining = Partitions.size();
+            Generation++;
+
+            Startsignal.notify_all();
+            Donesignal.wait(Lock, [] { return Remaining == 0; });
+        }
+
+        // Leave a core for the network, capped as the connection serializes the writes anyway.
+        static void Initialize()
+        {
+            const auto Count = std::min(8U, std::max(2U, std::thread::hardware_concurrency()) - 1);
+
+            Partitions.resize(Count);
+            if (Count > 1) for (size_t i = 0; i < Count; ++i) std::thread(Workerthread, i).detach();
+        }
+    }
+
+    // The whole batch is applied in one transaction, rather than an fsync per handler-insert.
+    static void Dispatch(std::vector<Message_t> &&Messages)
+    {
+        {
+            std::scoped_lock Lock(Dispatchlock);
+            std::shared_lock Registry(Registrylock);
+
+            // Senders expect their messages in order, what arrived together can be sorted.
+            std::ranges::stable_sort(Messages, std::less{}, &Message_t::Timestamp);
+            std::vector<const Message_t *> Processed{}, Invalid{};
+            Processed.reserve(Messages.size());
+
+            // Out-of-order delivery (e.g. from reconciliation) should not roll back newer state, checked once per batch.
+            const auto Superseded = Compaction::getSuperseded(Messages);
+
+            // No other transaction can be open while we hold the lock, so a failed BEGIN is a real error; retry the batch later.
+            std::scoped_lock Transaction(Backend::Transactionlock());
+            auto Database = Backend::Database();
+            try { Database << "BEGIN TRANSACTION;"; }
+            catch (const std::exception &e)
+            {
+                Errorprint(va("Messagestream: Could not start a transaction, retrying the batch: %s", e.what()));
+                Channel::Push(std::move(Messages));
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                return;
+            }
+
+            // Handlers run with the transaction held, so whoever is notified has to wait until it's done.
+            Notifications::Defer(true);
+            Partitions::Processbatch(Messages, Superseded);
+
+            // Counters are merged once per batch.
+            Hashmap<uint32_t, Stats::Counters_t> Counters{};
+            Stats::Histogram_t Latency{};
+
+            for (const auto &Partition : Partitions::Partitions)
+            {
+                for (const auto &[Messagetype, Time] : Partition.Handlertime) Counters[Messagetype].Handlertime += Time;
+                for (size_t i = 0; i < Stats::Bucketcount; ++i) Latency[i] += Partition.Latency[i];
+            }
+
+            for (size_t i = 0; i < Messages.size(); ++i)
+            {
+                const auto &Message = Messages[i];
+                bool isValid = Partitions::Results[i];
+
+                if (!Superseded.contains(&Message))
+                {
+                    const auto Start = std::chrono::steady_clock::now();
+                    isValid &= Processplugins(Message);
+                    Counters[Message.Messagetype].Handlertime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+                }
+
+                if (isValid) Processed.push_back(&Message);
+                else Invalid.push_back(&Message);
+
+                auto &Counter = Counters[Message.Messagetype];
+                (isValid ? Counter.Processed : Counter.Rejected)++;
+            }
+            Notifications::Defer(false);
+            Stats::onProcessed(Counters, Latency);
+
+            try
+            {
+                // Remove any invalid messages and update the status of the rest.
+                Updaterows("DELETE FROM Messagestream", Invalid);
+                Updaterows("UPDATE Messagestream SET isProcessed = true", Processed);
+            } catch (...) {}
+
+            try { Database << "COMMIT;"; }
+            catch (...) { try { Database << "ROLLBACK;"; } catch (...) {} }
+        }
+
+        // Subscribers can react with messages and requests of their own now that nothing is held.
+        Notifications::Flushdeferred();
+        Stats::Backlog -= Messages.size();
+    }
+
+    [[noreturn]] static void Dispatchthread()
+    {
+        // Name this thread for easier debugging.
+        setThreadname("Ayria_Processing");
+
+        while (true) Dispatch(Channel::Take());
+    }
+
+    // Replays the Messagestream into truncated service tables, for schema changes and handler bugs.
+    namespace Rebuild
+    {
+        static Hashset<std::string> Tables{};
+        static std::atomic<size_t> Processed{}, Rejected{}, Total{};
+        static std::atomic_flag isRunning{};
+        static std::atomic<bool> isReplaying{};
+
+        static void Run()
+        {
+            // Ingest stops for the duration: new messages wait in the channel, and Layer 1 waits for the transaction.
+            // That keeps the connection-wide pragma below from applying to anything but the rebuild.
+            std::scoped_lock Lock(Dispatchlock, Backend::Transactionlock());
+            std::shared_lock Registry(Registrylock);
+            auto Database = Backend::Database();
+            Processed = 0; Rejected = 0; Total = 0;
+
+            // Truncating a table should not cascade into the ones we keep (e.g. Groupkey).
+            int hasForeignkeys{ 1 };
+            try
+            {
+                Database << "PRAGMA foreign_keys = OFF;";
+                Database << "PRAGMA foreign_keys;" >> hasForeignkeys;
+            } catch (...) {}
+
+            // The pragma is a no-op inside of a transaction, which should not be possible while we hold the lock.
+            if (hasForeignkeys) [[unlikely]]
+            {
+                Warningprint("Messagestream: Could not disable foreign keys, try the rebuild again later.");
+                return;
+            }
+
+            const auto Start = std::chrono::steady_clock::now();
+            std::vector<std::string> Indexes{}, Existing{};
+            bool isTransaction{};
+
+            // Handlers replay history, so whatever they would tell the user about is old news.
+            isReplaying = true;
+            Notifications::Defer(true);
+
+            try
+            {
+                Database << "BEGIN TRANSACTION;"; isTransaction = true;
+
+                // Services may register tables that a failed migration or a disabled module never created.
+                for (const auto &Table : Tables)
+                {
+                    int Count{};
+                    Database << "SELECT COUNT(*) FROM sqlite_master WHERE (type = 'table' AND name = ?);" << Table >> Count;
+                    if (Count) Existing.push_back(Table);
+                    else Warningprint(va("Messagestream: Skipping the missing table %s.", Table.c_str()));
+                }
+
+                // Secondary indexes are cheaper to build once at the end than to maintain during the load.
+                for (const auto &Table : Existing)
+                {
+                    std::vector<std::string> Names{};
+                    Database << "SELECT name, sql FROM sqlite_master WHERE (type = 'index' AND sql IS NOT NULL AND tbl_name = ?);"
+                             << Table
+                             >> [&](std::string &&Name, std::string &&SQL)
+                             {
+                                 Names.emplace_back(std::move(Name));
+                                 Indexes.emplace_back(std::move(SQL));
+                             };
+
+                    for (const auto &Name : Names) Database << va(R"(DROP INDEX "%s";)", Name.c_str());
+                    Database << va(R"(DELETE FROM "%s";)", Table.c_str());
+
+                    // Truncation skips the update hook, the commit or rollback hook settles it with the rest of the transaction.
+                    Layer3::Invalidate(Table);
+                }
+
+                std::vector<Message_t> Messages{};
+                Database << "SELECT Sender, Messagetype, Timestamp, Signature, Message FROM Messagestream WHERE (isProcessed = true) ORDER BY Timestamp;"
+                         >> [&](std::string &&Sender, uint32_t Messagetype, uint64_t Timestamp, const std::vector<char> &Signature, const std::vector<char> &Message)
+                         {
+                             Messages.push_back({ std::move(Sender), Messagetype, Timestamp, { Signature.begin(), Signature.end() }, { Message.begin(), Message.end() } });
+                         };
+
+                Total = Messages.size();
+                Infoprint(va("Messagestream: Rebuilding %zu tables from %zu messages.", Existing.size(), Messages.size()));
+
+                // Invalid messages are only reported, the stream is the source of truth.
+                const auto Superseded = Compaction::getSuperseded(Messages);
+                const auto Step = std::max(size_t(1), Messages.size() / 10);
+                for (const auto &Message : Messages)
+                {
+                    if (!Superseded.contains(&Message) && !Process(Message)) Rejected++;
+                    if (++Processed % Step == 0) Infoprint(va("Messagestream: Rebuild at %zu%%.", Processed * 100 / Messages.size()));
+                }
+
+                for (const auto &SQL : Indexes) Database << SQL;
+                Database << "COMMIT;";
+
+                const auto Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+                Infoprint(va("Messagestream: Rebuild done in %.1f seconds, %zu messages rejected.", Seconds, Rejected.load()));
+            }
+            catch (const std::exception &e)
+            {
+                Errorprint(va("Messagestream: Rebuild failed: %s", e.what()));
+                if (isTransaction) try { Database << "ROLLBACK;"; } catch (...) {}
+            }
+
+            // Neither the handlers notifications nor the rows they changed should reach the subscribers.
+            Notifications::Defer(false);
+            Notifications::Flushdeferred(true);
+            for (const auto &Table : Existing) Backend::getModified(Table);
+            isReplaying = false;
+
+            try { Database << "PRAGMA foreign_keys = ON;"; } catch (...) {}
+        }
+
+        static bool Start()
+        {
+            if (isRunning.test_and_set()) return false;
+
+            std::thread([]()
+            {
+                setThreadname("Ayria_Rebuild");
+                Run();
+                isRunning.clear();
+            }).detach();
+            return true;
+        }
+
+        // Layer 3 interaction.
+        static std::string __cdecl Startrebuild(JSON::Value_t &&)
+        {
+            if (!Start()) return R"({ "Error" : "A rebuild is already running." })";
+            return "{}";
+        }
+        static std::string __cdecl getProgress(JSON::Value_t &&)
+        {
+            const auto Count = Total.load();
+            return JSON::Dump(JSON::Object_t({
+                { "Progress", Count ? double(Processed) / Count : 0.0 },
+                { "isRunning", isRunning.test() },
+                { "Processed", Processed.load() },
+                { "Rejected", Rejected.load() },
+                { "Total", Count }
+            }));
+        }
+
+        // Usage: Messagestream::Rebuild, progress is printed to the console.
+        static void __cdecl Rebuildcommand(int, const char **)
+        {
+            if (!Start()) Warningprint("Messagestream: A rebuild is already running.");
+        }
+    }
+
+    // Tables only written by handlers, so they can be recreated from the stream.
+    void addDerivedtable(std::string_view Tablename)
+    {
+        Rebuild::Tables.emplace(Tablename);
+    }
+    bool isRebuilding()
+    {
+        return Rebuild::isReplaying;
+    }
+
+    // Anything stored but not processed before the last shutdown.
+    static void Recover()
+    {
+        std::vector<Message_t> Messages{};
+
+        try
+        {
+            Backend::Database()
+                << "SELECT Sender, Messagetype, Timestamp, Signature, Message FROM Messagestream WHERE (isProcessed = false) ORDER BY Timestamp;"
+                >> [&](std::string &&Sender, uint32_t Messagetype, uint64_t Timestamp, const std::vector<char> &Signature, const std::vector<char> &Message)
+                {
+                    Messages.push_back({ std::move(Sender), Messagetype, Timestamp, { Signature.begin(), Signature.end() }, { Message.begin(), Message.end() } });
+                };
         } catch (...) {}
+
+        if (!Messages.empty()) Infoprint(va("Messagestream: Recovering %zu unprocessed messages.", Messages.size()));
+        Enqueue(std::move(Messages));
     }
 
-    // Set up the system.
+    // Background tasks only run once services and plugins are loaded, so all handlers are registered by then.
+    static void __cdecl Startdispatch()
+    {
+        static std::once_flag Started{};
+        std::call_once(Started, []()
+        {
+            Partitions::Initialize();
+            std::thread(Dispatchthread).detach();
+        });
+    }
+
+    // Set up the system, before Layer 1 so that recovery doesn't race new messages.
     void Initialize()
     {
-        // TODO(tcn): Profile and decide on a proper rate..
-        Backend::Enqueuetask(100, doProcess);
+        Recover();
+        Backend::Enqueuetask(100, Startdispatch);
+        Backend::Enqueuetask(5000, Compaction::doCompact);
+
+        Layer3::addEndpoint("Messagestream::Rebuild", Rebuild::Startrebuild);
+        Layer3::addEndpoint("Messagestream::getRebuild", Rebuild::getProgress);
+        Console::addCommand("Messagestream::Rebuild"sv, Rebuild::Rebuildcommand);
+
+        Layer3::addEndpoint("Messageprocessing::getStats", Stats::getStats);
+        Console::addCommand("Messageprocessing::Stats"sv, Stats::Printstats);
     }
 
     namespace Export
@@ -71,7 +870,7 @@ namespace Backend::Messageprocessing
         extern "C" void subscribeMessage(const char *Identifier, bool (__cdecl * Callback)(uint64_t Timestamp, const char *LongID, const char *Message, unsigned int Length))
         {
             if (Identifier && Callback) [[likely]]
-                Messageprocessing::addMessagehandler(std::string_view{ Identifier }, Callback);
+                Messageprocessing::addPluginhandler(std::string_view{ Identifier }, Callback);
         }
     }
 }
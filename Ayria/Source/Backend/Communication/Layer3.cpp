@@ -9,7 +9,6 @@
 namespace Backend::JSONAPI
 {
     static Hashmap<std::string, Callback_t> Requesthandlers{};
-    static Ringbuffer_t<std::string, 16> Results{};
 
     // Rather than adding generic results to the buffer.
     constexpr auto Generichash = Hash::WW32("{}");
@@ -24,36 +23,372 @@ namespace Backend::JSONAPI
         if (Callback) Requesthandlers[std::string(Functionname)] = Callback;
     }
 
-    // For internal use.
-    const char *callEndpoint(std::string_view Functionname, JSON::Value_t &&Request)
+    // Empty for generic results, so callers can skip storing them.
+    static std::string doRequest(std::string_view Functionname, JSON::Value_t &&Request)
     {
-        if (!Requesthandlers.contains(Functionname)) [[unlikely]]
+        const auto Handler = Requesthandlers.find(Functionname);
+        if (Handler == Requesthandlers.end()) [[unlikely]]
         {
-            static std::string Failurestring = va(R"({ "Error" : "No endpoint with name %*s available.", \n"Endpoints" : [\n)",
+            auto Failurestring = va(R"({ "Error" : "No endpoint with name %*s available.", \n"Endpoints" : [\n)",
             Functionname.size(), Functionname.data());
 
             for (const auto &Name : Requesthandlers | std::views::keys)
             {
-                Failurestring.append(Name);
-                Failurestring.append(",");
+                Failurestring.append(va(R"("%s",)", Name.c_str()));
             }
 
-            Failurestring.pop_back();
+            if (Failurestring.back() == ',') Failurestring.pop_back();
             Failurestring.append(R"(] })");
-            return Failurestring.c_str();
+            return Failurestring;
+        }
+
+        auto Result = Handler->second(std::move(Request));
+        if (Result.empty() || Hash::WW32(Result) == Generichash) [[likely]] return {};
+        return Result;
+    }
+
+    // Each thread gets its own ring, so concurrent callers can't evict each others results.
+    static const char *Saveresult(std::shared_ptr<const std::string> &&Result)
+    {
+        thread_local Ringbuffer_t<std::shared_ptr<const std::string>, 16> Results{};
+        if (!Result || Result->empty()) [[likely]] return Genericresult;
+
+        // Save the result on the heap for 16 calls, cached results are shared rather than copied.
+        return Results.emplace_back(std::move(Result))->c_str();
+    }
+    static const char *Saveresult(std::string &&Result)
+    {
+        if (Result.empty()) [[likely]] return Genericresult;
+        return Saveresult(std::make_shared<const std::string>(std::move(Result)));
+    }
+
+    // For internal use.
+    const char *callEndpoint(std::string_view Functionname, JSON::Value_t &&Request)
+    {
+        return Saveresult(doRequest(Functionname, std::move(Request)));
+    }
+
+    // Results of read-only endpoints are reused until one of the tables they read from changes.
+    namespace Cache
+    {
+        // The full key is kept with the result, a hash collision should be a miss rather than someone else's result.
+        using Entry_t = struct { uint64_t Generation; std::string Functionname, Request; std::shared_ptr<const std::string> Result; };
+        static Hashmap<std::string, std::vector<std::string>> Dependencies{};
+        static Hashmap<std::string, uint64_t> Generations{};
+        static Hashset<std::string> Uncommitted{};
+        static Hashmap<uint64_t, Entry_t> Entries{};
+        static std::mutex Cachelock{};
+
+        // Distinct requests are cheap to recompute, so just start over when full.
+        constexpr size_t Maxentries = 4096;
+
+        static void addDependencies(std::string_view Functionname, std::initializer_list<std::string_view> Tables)
+        {
+            std::scoped_lock Lock(Cachelock);
+            auto &Entry = Dependencies[std::string(Functionname)];
+
+            for (const auto &Table : Tables)
+            {
+                Entry.emplace_back(Table);
+                Generations.try_emplace(std::string(Table), 0);
+            }
+        }
+
+        // Sum of the tables generations, NULL while a table has changes in an open transaction.
+        static std::optional<uint64_t> getGeneration(const std::vector<std::string> &Tables)
+        {
+            uint64_t Generation{};
+            for (const auto &Table : Tables)
+            {
+                if (Uncommitted.contains(Table)) [[unlikely]] return {};
+                Generation += Generations[Table];
+            }
+
+            return Generation;
+        }
+
+        // Returns NULL for endpoints that are not cached.
+        static std::shared_ptr<const std::string> Request(std::string_view Functionname, const char *JSONString)
+        {
+            const std::string_view Requeststring = JSONString ? JSONString : "";
+            const auto Key = Hash::WW64(Functionname) * 31 + Hash::WW64(Requeststring);
+            std::optional<uint64_t> Generation{};
+
+            {
+                std::scoped_lock Lock(Cachelock);
+
+                const auto Tables = Dependencies.find(Functionname);
+                if (Tables == Dependencies.end()) [[likely]] return {};
+
+                Generation = getGeneration(Tables->second);
+                if (Generation)
+                {
+                    if (const auto Entry = Entries.find(Key); Entry != Entries.end() && Entry->second.Generation == *Generation &&
+                        Entry->second.Functionname == Functionname && Entry->second.Request == Requeststring)
+                        return Entry->second.Result;
+                }
+            }
+
+            // Run outside of the lock, an entry made stale while running will not match the new generation.
+            auto Result = std::make_shared<const std::string>(doRequest(Functionname, JSON::Parse(JSONString)));
+            if (!Generation) [[unlikely]] return Result;
+
+            std::scoped_lock Lock(Cachelock);
+            if (Entries.size() >= Maxentries) [[unlikely]] Entries.clear();
+            Entries[Key] = { *Generation, std::string(Functionname), std::string(Requeststring), Result };
+            return Result;
         }
 
-        const auto Result = Requesthandlers[std::string(Functionname)](std::move(Request));
-        if (Result.empty() || Hash::WW32(Result) == Generichash) [[likely]] return Genericresult;
+        // Called from the update-hook for every row changed on the shared connection, which readers use as well.
+        // Changes are reported before they are committed, so the table bypasses the cache until the transaction ends.
+        static void Invalidate(std::string_view Tablename)
+        {
+            std::scoped_lock Lock(Cachelock);
+
+            const auto Generation = Generations.find(Tablename);
+            if (Generation == Generations.end()) [[likely]] return;
 
-        // Save the result on the heap for 16 calls.
-        return Results.emplace_back(Result).c_str();
+            Generation->second++;
+            Uncommitted.emplace(Tablename);
+        }
+
+        // Called from the commit and rollback hooks, bumped again so results computed mid-transaction never match.
+        static void onTransactionend()
+        {
+            std::scoped_lock Lock(Cachelock);
+            for (const auto &Table : Uncommitted) Generations[Table]++;
+            Uncommitted.clear();
+        }
+    }
+
+    // Read-only endpoints, the result is cached per request until one of the tables is modified.
+    void addEndpoint(std::string_view Functionname, Callback_t Callback, std::initializer_list<std::string_view> Tables)
+    {
+        if (!Callback) [[unlikely]] return;
+
+        addEndpoint(Functionname, Callback);
+        Cache::addDependencies(Functionname, Tables);
+    }
+    void Invalidate(std::string_view Tablename)
+    {
+        Cache::Invalidate(Tablename);
+    }
+    void onTransactionend()
+    {
+        Cache::onTransactionend();
+    }
+
+    // Endpoints that do crypto or publish should not stall the callers thread (often the games render thread).
+    // Plugins already call endpoints from whichever thread they like, so running them on a pool adds no new concurrency.
+    namespace Async
+    {
+        using Completioncallback_t = void(__cdecl *)(const char *Result, void *Userdata);
+        using Completion_t = struct { std::string Result; Completioncallback_t Callback; void *Userdata; };
+        using Completionqueue_t = struct { std::mutex Lock; std::vector<Completion_t> Completed; };
+
+        static std::condition_variable Jobsignal{};
+        static std::queue<std::function<void()>> Jobqueue{};
+        static std::mutex Joblock{};
+
+        // Completions are delivered to the thread that submitted the request, when it calls the pump.
+        static std::shared_ptr<Completionqueue_t> getQueue()
+        {
+            thread_local const auto Queue = std::make_shared<Completionqueue_t>();
+            return Queue;
+        }
+
+        [[noreturn]] static void Workerthread()
+        {
+            // Name this thread for easier debugging.
+            setThreadname("Ayria_JSONAPI");
+
+            while (true)
+            {
+                std::function<void()> Job{};
+                {
+                    std::unique_lock Lock(Joblock);
+                    Jobsignal.wait(Lock, [] { return !Jobqueue.empty(); });
+                    Job = std::move(Jobqueue.front());
+                    Jobqueue.pop();
+                }
+
+                // A throwing handler should not take the worker with it.
+                try { Job(); } catch (...) {}
+            }
+        }
+
+        // Started on first use, most plugins never make async calls.
+        static void Enqueue(std::function<void()> &&Job)
+        {
+            static std::once_flag Started{};
+            std::call_once(Started, []()
+            {
+                const auto Count = std::clamp(std::thread::hardware_concurrency() / 2, 2U, 4U);
+                for (uint32_t i = 0; i < Count; ++i) std::thread(Workerthread).detach();
+            });
+
+            {
+                std::scoped_lock Lock(Joblock);
+                Jobqueue.push(std::move(Job));
+            }
+            Jobsignal.notify_one();
+        }
+
+        static void Submit(std::string &&Function, JSON::Value_t &&Request, Completioncallback_t Callback, void *Userdata)
+        {
+            Enqueue([Function = std::move(Function), Request = std::move(Request), Callback, Userdata, Queue = getQueue()]() mutable
+            {
+                std::string Result{};
+                try { Result = doRequest(Function, std::move(Request)); } catch (...) {}
+                if (!Callback) return;
+
+                std::scoped_lock Lock(Queue->Lock);
+                Queue->Completed.push_back({ std::move(Result), Callback, Userdata });
+            });
+        }
+
+        static size_t Runcallbacks()
+        {
+            std::vector<Completion_t> Completed{};
+            {
+                const auto Queue = getQueue();
+                std::scoped_lock Lock(Queue->Lock);
+                Completed.swap(Queue->Completed);
+            }
+
+            // The result is only valid for the duration of the callback.
+            for (const auto &[Result, Callback, Userdata] : Completed)
+                Callback(Result.empty() ? Genericresult : Result.c_str(), Userdata);
+
+            return Completed.size();
+        }
+    }
+
+    // Many calls in one crossing. Ordered batches run on the callers thread, unordered ones are shared with the pool.
+    static std::string doBatch(JSON::Array_t &&Requests, bool isOrdered)
+    {
+        struct Batch_t { JSON::Array_t Requests; std::vector<std::string> Results; std::atomic<size_t> Next, Done; std::mutex Lock; std::condition_variable Signal; };
+        const auto Batch = std::make_shared<Batch_t>();
+        Batch->Results.resize(Requests.size());
+        Batch->Requests = std::move(Requests);
+
+        // Whoever gets to a request first runs it, helpers that start late find nothing left.
+        const auto Work = [](const std::shared_ptr<Batch_t> &Batch)
+        {
+            for (auto Index = Batch->Next++; Index < Batch->Requests.size(); Index = Batch->Next++)
+            {
+                auto &Request = Batch->Requests[Index];
+                try { Batch->Results[Index] = doRequest(Request.value<std::string>("Function"), Request.value<JSON::Value_t>("Payload")); } catch (...) {}
+
+                if (++Batch->Done == Batch->Requests.size())
+                {
+                    std::scoped_lock Lock(Batch->Lock);
+                    Batch->Signal.notify_all();
+                }
+            }
+        };
+
+        // The caller works too, so the batch completes even if the pool is busy.
+        if (!isOrdered && Batch->Requests.size() > 1)
+        {
+            for (size_t i = 1; i < std::min<size_t>(Batch->Requests.size(), 4); ++i)
+                Async::Enqueue([=]() { Work(Batch); });
+        }
+
+        Work(Batch);
+        {
+            std::unique_lock Lock(Batch->Lock);
+            Batch->Signal.wait(Lock, [&] { return Batch->Done == Batch->Requests.size(); });
+        }
+
+        // The handlers already serialized their results, no need to parse them again.
+        std::string Response{ "[" };
+        for (const auto &Result : Batch->Results)
+        {
+            Response.append(Result.empty() ? Genericresult : Result);
+            Response.append(",");
+        }
+        if (Response.back() == ',') Response.pop_back();
+        Response.append("]");
+
+        return Response;
+    }
+
+    // Results that live until the plugin releases them, rather than for the next 16 calls.
+    namespace Shared
+    {
+        using Entry_t = struct { std::string Result; uint32_t References; };
+        static Hashmap<const char *, std::unique_ptr<Entry_t>> Entries{};
+        static std::mutex Entrylock{};
+
+        static const char *Insert(std::string &&Result)
+        {
+            if (Result.empty()) [[likely]] return Genericresult;
+
+            auto Entry = std::make_unique<Entry_t>(std::move(Result), 1U);
+            const auto Pointer = Entry->Result.c_str();
+
+            std::scoped_lock Lock(Entrylock);
+            Entries.emplace(Pointer, std::move(Entry));
+            return Pointer;
+        }
+        static void Retain(const char *Pointer)
+        {
+            std::scoped_lock Lock(Entrylock);
+            if (const auto Entry = Entries.find(Pointer); Entry != Entries.end()) [[likely]]
+                Entry->second->References++;
+        }
+        static void Release(const char *Pointer)
+        {
+            std::scoped_lock Lock(Entrylock);
+            if (const auto Entry = Entries.find(Pointer); Entry != Entries.end()) [[likely]]
+                if (--Entry->second->References == 0) Entries.erase(Entry);
+        }
     }
 
     // Access from the plugins.
     extern "C" EXPORT_ATTR const char *__cdecl JSONRequest(const char *Function, const char *JSONString)
     {
         std::string_view Functionname = Function ? Function : "";
+
+        // Read-only endpoints skip parsing and the handler when nothing has changed.
+        if (auto Cached = Cache::Request(Functionname, JSONString)) return Saveresult(std::move(Cached));
         return callEndpoint(Functionname, JSON::Parse(JSONString));
     }
+
+    // Array of { "Function" : "", "Payload" : {} } objects, returns an array of the results in the same order.
+    // Unordered requests run concurrently, so they should not depend on each other.
+    extern "C" EXPORT_ATTR const char *__cdecl JSONBatchrequest(const char *JSONString, bool isOrdered)
+    {
+        const auto Request = JSON::Parse(JSONString);
+        if (Request.Type != JSON::Type_t::Array) [[unlikely]] return R"({ "Error" : "Expected an array of requests." })";
+
+        JSON::Array_t Requests = Request;
+        return Saveresult(doBatch(std::move(Requests), isOrdered));
+    }
+
+    // The result is owned by the caller until the last JSONRelease, generic results are static and may be released too.
+    extern "C" EXPORT_ATTR const char *__cdecl JSONRequestshared(const char *Function, const char *JSONString)
+    {
+        std::string_view Functionname = Function ? Function : "";
+        return Shared::Insert(doRequest(Functionname, JSON::Parse(JSONString)));
+    }
+    extern "C" EXPORT_ATTR void __cdecl JSONRetain(const char *Result)
+    {
+        if (Result) [[likely]] Shared::Retain(Result);
+    }
+    extern "C" EXPORT_ATTR void __cdecl JSONRelease(const char *Result)
+    {
+        if (Result) [[likely]] Shared::Release(Result);
+    }
+
+    // Runs on the backends pool, the callback (if any) runs on this thread during JSONRuncallbacks.
+    extern "C" EXPORT_ATTR void __cdecl JSONRequestAsync(const char *Function, const char *JSONString, void(__cdecl *Callback)(const char *Result, void *Userdata), void *Userdata)
+    {
+        Async::Submit(Function ? Function : "", JSON::Parse(JSONString), Callback, Userdata);
+    }
+    extern "C" EXPORT_ATTR unsigned int __cdecl JSONRuncallbacks()
+    {
+        return static_cast<uint32_t>(Async::Runcallbacks());
+    }
 }
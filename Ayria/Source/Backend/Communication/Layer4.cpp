@@ -11,6 +11,11 @@ namespace Backend::Notifications
     static Hashmap<std::string, Hashset<Processor_t>> ProcessingCB;
     static Hashmap<uint32_t, Hashset<Callback_t>> NotificationCB;
 
+    // Subscribers may call back into the backend, which would wait on the transaction the publisher holds.
+    static std::vector<std::pair<uint32_t, std::string>> Deferred{};
+    static thread_local bool isDeferring{};
+    static std::mutex Deferredlock{};
+
     void Unsubscribe(std::string_view Identifier, Callback_t Handler)
     {
         NotificationCB[Hash::WW32(Identifier)].erase(Handler);
@@ -19,6 +24,14 @@ namespace Backend::Notifications
     {
         const auto Hash = Hash::WW32(Identifier);
         if (!NotificationCB.contains(Hash)) return;
+
+        if (isDeferring) [[unlikely]]
+        {
+            std::scoped_lock Lock(Deferredlock);
+            Deferred.emplace_back(Hash, JSONString);
+            return;
+        }
+
         for (const auto &CB : NotificationCB[Hash]) CB(JSONString);
     }
     void Subscribe(std::string_view Identifier, Callback_t Handler)
@@ -27,6 +40,22 @@ namespace Backend::Notifications
     }
 
     // Internal.
+    void Defer(bool Enable)
+    {
+        isDeferring = Enable;
+    }
+    void Flushdeferred(bool Discard)
+    {
+        std::vector<std::pair<uint32_t, std::string>> Pending{};
+        {
+            std::scoped_lock Lock(Deferredlock);
+            Pending.swap(Deferred);
+        }
+
+        if (Discard) return;
+        for (const auto &[Hash, JSONString] : Pending)
+            for (const auto &CB : NotificationCB[Hash]) CB(JSONString.c_str());
+    }
     void addProcessor(std::string_view Tablename, Processor_t Callback)
     {
         ProcessingCB[Tablename].insert(Callback);
@@ -0,0 +1,198 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+
+    The self-contained parts of the Messagebus, kept out of Layer1.cpp so that they can be tested without a network or DB.
+*/
+
+#pragma once
+#include <Stdinclude.hpp>
+
+namespace Backend::Messagebus
+{
+    // Largest body that is guaranteed to fit in a frame after compression.
+    constexpr size_t Maxblocksize = 63 * 1024;
+
+    // Each link is compressed as one stream, so small messages can reference earlier ones.
+    struct Streamencoder_t
+    {
+        LZ4_stream_t Stream{};
+        std::vector<char> Ring = std::vector<char>(64 * 1024 + Maxblocksize);
+        size_t Offset{};
+
+        Streamencoder_t() { LZ4_initStream(&Stream, sizeof(Stream)); }
+
+        // Output needs to hold LZ4_COMPRESSBOUND(Input.size()), returns the compressed size.
+        int Compress(std::string_view Input, char *Output)
+        {
+            assert(Input.size() <= Maxblocksize);
+
+            // The input needs to stay in place while it's part of the dictionary.
+            if (Offset + Input.size() > Ring.size()) Offset = 0;
+            const auto Source = Ring.data() + Offset;
+            std::memcpy(Source, Input.data(), Input.size());
+            Offset += Input.size();
+
+            return LZ4_compress_fast_continue(&Stream, Source, Output, int(Input.size()), LZ4_COMPRESSBOUND(int(Input.size())), 1);
+        }
+    };
+    struct Streamdecoder_t
+    {
+        LZ4_streamDecode_t Stream{};
+        std::vector<char> Ring = std::vector<char>(LZ4_DECODER_RING_BUFFER_SIZE(Maxblocksize));
+        size_t Offset{};
+
+        Streamdecoder_t() { LZ4_setStreamDecode(&Stream, nullptr, 0); }
+
+        // The result is valid until the ring wraps.
+        std::optional<std::string_view> Decompress(std::string_view Input)
+        {
+            if (Offset + Maxblocksize > Ring.size()) Offset = 0;
+
+            const auto Output = Ring.data() + Offset;
+            const auto Size = LZ4_decompress_safe_continue(&Stream, Input.data(), Output, int(Input.size()), int(Maxblocksize));
+            if (Size < 0) [[unlikely]] return {};
+
+            Offset += Size;
+            return std::string_view(Output, Size);
+        }
+    };
+
+    // Batched messages share one signature over a Merkle-root, each message keeps the proof for its leaf.
+    namespace Merkle
+    {
+        // Domain separation so that leaves can't be passed off as inner nodes.
+        inline std::string Leaf(std::string_view Data) { return Hash::SHA256("\x00"s + std::string(Data)); }
+        inline std::string Node(const std::string &Left, const std::string &Right) { return Hash::SHA256("\x01"s + Left + Right); }
+
+        // Levels.front() are the leaves, Levels.back() is the root. Odd nodes are paired with themselves.
+        inline std::vector<std::vector<std::string>> Build(std::vector<std::string> &&Leaves)
+        {
+            std::vector<std::vector<std::string>> Levels{ std::move(Leaves) };
+
+            while (Levels.back().size() > 1)
+            {
+                const auto &Current = Levels.back();
+                std::vector<std::string> Next; Next.reserve((Current.size() + 1) / 2);
+
+                for (size_t i = 0; i < Current.size(); i += 2)
+                    Next.push_back(Node(Current[i], Current[std::min(i + 1, Current.size() - 1)]));
+
+                Levels.push_back(std::move(Next));
+            }
+
+            return Levels;
+        }
+
+        // Proof = uint32_t Index + sibling hashes.
+        inline std::string Proof(const std::vector<std::vector<std::string>> &Levels, uint32_t Index)
+        {
+            std::string Result((const char *)&Index, sizeof(Index));
+
+            for (size_t i = 0; i + 1 < Levels.size(); ++i)
+            {
+                const auto &Level = Levels[i];
+                Result += Level[std::min(size_t(Index ^ 1), Level.size() - 1)];
+                Index >>= 1;
+            }
+
+            return Result;
+        }
+        inline std::optional<std::string> Root(std::string_view Data, std::string_view Proof)
+        {
+            if (Proof.size() < sizeof(uint32_t) || (Proof.size() - sizeof(uint32_t)) % 32) [[unlikely]] return {};
+
+            auto Index = *(const uint32_t *)Proof.data();
+            Proof.remove_prefix(sizeof(uint32_t));
+
+            auto Hash = Leaf(Data);
+            while (!Proof.empty())
+            {
+                const auto Sibling = std::string(Proof.substr(0, 32));
+                Hash = (Index & 1) ? Node(Sibling, Hash) : Node(Hash, Sibling);
+                Proof.remove_prefix(32);
+                Index >>= 1;
+            }
+
+            return Hash;
+        }
+    }
+
+    // Range-based reconciliation, both sides split the timeline the same way and only descend where the fingerprints differ.
+    namespace Sync
+    {
+        // Ranges smaller than this are resolved by exchanging IDs rather than splitting further.
+        constexpr size_t Leafthreshold = 32, Maxids = 4096, Splitcount = 16;
+
+        #pragma pack(push, 1)
+        struct Range_t { uint64_t Start, End; uint32_t Count; uint64_t Fingerprint; };
+        #pragma pack(pop)
+
+        // ID is a hash of (Sender, Signature), so the XOR of a ranges IDs can be merged from its sub-ranges.
+        struct Entry_t { int64_t RowID; uint64_t Timestamp; uint64_t ID; };
+
+        inline Range_t getRange(uint64_t Start, uint64_t End, std::span<const Entry_t> Entries)
+        {
+            Range_t Range{ Start, End, 0, 0 };
+
+            for (const auto &Entry : Entries)
+            {
+                if (Entry.Timestamp < Start || Entry.Timestamp >= End) continue;
+                Range.Fingerprint ^= Entry.ID;
+                Range.Count++;
+            }
+
+            return Range;
+        }
+        inline std::vector<Range_t> Split(uint64_t Start, uint64_t End, std::span<const Entry_t> Entries)
+        {
+            std::vector<Range_t> Result{}; Result.reserve(Splitcount);
+            const auto Step = std::max((End - Start) / Splitcount, uint64_t(1));
+
+            for (auto Current = Start; Current < End; Current += Step)
+            {
+                const auto Next = (End - Current <= Step || Result.size() == Splitcount - 1) ? End : Current + Step;
+                Result.push_back(getRange(Current, Next, Entries));
+                if (Next == End) break;
+            }
+
+            return Result;
+        }
+
+        // Entries are sorted by timestamp, long lists are cut between timestamps so that each chunk covers its own sub-range.
+        struct Chunk_t { uint64_t Start, End; std::span<const Entry_t> Entries; };
+        inline std::vector<Chunk_t> Chunkentries(uint64_t Start, uint64_t End, std::span<const Entry_t> Entries, size_t Chunksize)
+        {
+            const auto Stop = std::ranges::lower_bound(Entries, End, {}, &Entry_t::Timestamp);
+            auto Current = std::ranges::lower_bound(Entries, Start, {}, &Entry_t::Timestamp);
+            std::vector<Chunk_t> Result{};
+            auto Chunkstart = Start;
+
+            while (Chunkstart < End)
+            {
+                auto Last = size_t(Stop - Current) > Chunksize ? Current + Chunksize : Stop;
+                auto Next = Last;
+                auto Chunkend = End;
+
+                if (Last != Stop)
+                {
+                    // Don't split a timestamp between chunks, unless the whole chunk shares one; the rest of it is skipped and resolved by the peers reply.
+                    const auto Cut = std::ranges::lower_bound(Current, Last, Last->Timestamp, {}, &Entry_t::Timestamp);
+                    if (Cut != Current) { Last = Next = Cut; Chunkend = Cut->Timestamp; }
+                    else
+                    {
+                        Chunkend = Last->Timestamp + 1;
+                        Next = std::ranges::upper_bound(Last, Stop, Last->Timestamp, {}, &Entry_t::Timestamp);
+                    }
+                }
+
+                Result.push_back({ Chunkstart, Chunkend, std::span(Current, Last) });
+                Chunkstart = Chunkend;
+                Current = Next;
+            }
+
+            return Result;
+        }
+    }
+}
@@ -234,6 +234,128 @@ namespace Console
         addCommand("List"sv, List);
         addCommand("Help"sv, List);
 
+        // Usage: Benchmark::qDSA [Count], runs on every core in the background and reports per core.
+        static const auto Benchmark = [](int argc, const char **argv)
+        {
+            const auto Count = std::clamp(argc > 0 ? std::atoi(argv[0]) : 2048, 64, 1 << 20);
+
+            std::thread([Count]()
+            {
+                // A handful of senders, similar to what a node sees in practice.
+                std::vector<std::array<uint8_t, 32>> Publickeys(8);
+                std::vector<std::array<uint8_t, 64>> Signatures(Count);
+                std::vector<std::string> Messages(Count);
+                std::vector<std::array<uint8_t, 32>> Privatekeys{};
+
+                for (auto &Publickey : Publickeys)
+                {
+                    std::array<uint8_t, 32> Seed{};
+                    RAND_bytes(Seed.data(), int(Seed.size()));
+                    const auto [Public, Private] = qDSA::Createkeypair(Seed);
+                    Publickey = Public;
+                    Privatekeys.push_back(Private);
+                }
+
+                std::vector<qDSA::Batchentry_t> Batch{}; Batch.reserve(Count);
+                for (int i = 0; i < Count; ++i)
+                {
+                    Messages[i] = va("Benchmark message %i", i);
+                    Signatures[i] = qDSA::Sign(Publickeys[i % 8], Privatekeys[i % 8], Messages[i]);
+                    Batch.push_back({ Publickeys[i % 8], Signatures[i], Messages[i] });
+                }
+
+                const auto Measure = [&](auto &&Callback)
+                {
+                    const auto Threads = std::max(1U, std::thread::hardware_concurrency());
+                    const auto Start = std::chrono::steady_clock::now();
+
+                    std::vector<std::thread> Workers{};
+                    for (uint32_t i = 0; i < Threads; ++i) Workers.emplace_back(Callback);
+                    for (auto &Worker : Workers) Worker.join();
+
+                    const auto Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+                    return Count / Seconds;
+                };
+
+                const auto Single = Measure([&]()
+                {
+                    for (int i = 0; i < Count; ++i) (void)qDSA::Verify(Publickeys[i % 8], Signatures[i], Messages[i]);
+                });
+                const auto Batched = Measure([&]()
+                {
+                    (void)qDSA::Verifybatch(Batch);
+                });
+
+                Infoprint(va("qDSA: %.0f verifications/s per core individually, %.0f batched.", Single, Batched));
+            }).detach();
+        };
+        addCommand("Benchmark::qDSA"sv, Benchmark);
+
+        // Usage: BinaryAPI::Header, writes the C header for the binary endpoints to ./Ayria/AyriaBinaryAPI.h
+        static const auto Header = [](int, const char **)
+        {
+            if (FS::Writefile(L"./Ayria/AyriaBinaryAPI.h", Backend::BinaryAPI::Generateheader()))
+                Infoprint("BinaryAPI: Wrote ./Ayria/AyriaBinaryAPI.h");
+        };
+        addCommand("BinaryAPI::Header"sv, Header);
+
+        // The echo endpoints would show up in the production registries and generated header, so debug builds only.
+        if constexpr (Build::isDebug)
+        {
+            // Same shape as the common game calls, but without side-effects.
+            Layer3::addEndpoint("Benchmark::Echo", [](JSON::Value_t &&Request) -> std::string { return JSON::Dump(Request); });
+            Backend::BinaryAPI::addEndpoint("Benchmark::Echo", { { "isHosting", BB_BOOL }, { "GameID", BB_UINT32 }, { "Key", BB_ASCIISTRING } },
+                [](Bytebuffer &Arguments, Bytebuffer &Result) -> bool
+                {
+                    Result.Write(Arguments.Read<bool>());
+                    Result.Write(Arguments.Read<uint32_t>());
+                    Result.Write(Arguments.Read<std::string>());
+                    return true;
+                });
+
+            // Usage: Benchmark::BinaryAPI [Count], the full plugin round-trip including encoding and decoding the result.
+            static const auto BenchmarkAPI = [](int argc, const char **argv)
+            {
+                const auto Count = std::clamp(argc > 0 ? std::atoi(argv[0]) : 100000, 1000, 10000000);
+
+                std::thread([Count]()
+                {
+                    const auto Measure = [Count](auto &&Callback)
+                    {
+                        const auto Start = std::chrono::steady_clock::now();
+                        for (int i = 0; i < Count; ++i) Callback(i);
+                        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / Count;
+                    };
+
+                    const auto JSONtime = Measure([](int i)
+                    {
+                        const auto Request = JSON::Object_t({ { "isHosting", (i & 1) == 1 }, { "GameID", uint32_t(i) }, { "Key", "Benchmark"s } });
+                        const auto Result = JSON::Parse(Layer3::callEndpoint("Benchmark::Echo", JSON::Parse(JSON::Dump(Request))));
+                        (void)Result.value<uint32_t>("GameID");
+                    });
+                    const auto Binarytime = Measure([](int i)
+                    {
+                        constexpr auto FunctionID = Hash::WW32("Benchmark::Echo");
+                        Bytebuffer Request{}, Result{};
+                        Request.Write((i & 1) == 1);
+                        Request.Write(uint32_t(i));
+                        Request.Write("Benchmark"s);
+
+                        Request.Internaliterator = 0;
+                        if (Backend::BinaryAPI::callEndpoint(FunctionID, Request, Result))
+                        {
+                            Result.Internaliterator = 0;
+                            (void)Result.Read<bool>();
+                            (void)Result.Read<uint32_t>();
+                        }
+                    });
+
+                    Infoprint(va("BinaryAPI: %.0f ns per call over JSON, %.0f ns binary.", JSONtime, Binarytime));
+                }).detach();
+            };
+            addCommand("Benchmark::BinaryAPI"sv, BenchmarkAPI);
+        }
+
         Layer3::addEndpoint("Console::Exec", API::execCommand);
         Layer3::addEndpoint("Console::Print", API::printLine);
     }
@@ -43,6 +43,8 @@ class Globalstate_t
                 enableIATHooking : 1,
                 enableFileshare : 1,
                 modifiedConfig : 1,
+                enableBatching : 1,
+                enableGossip : 1,
                 noNetworking : 1,
                 pruneDB : 1,
 
@@ -54,8 +56,8 @@ class Globalstate_t
                 isHosting : 1,
                 isIngame : 1,
 
-                // 6 bits available.
-                PLACEHOLDER : 6;
+                // 4 bits available.
+                PLACEHOLDER : 4;
         };
     } Settings{};
     // 30 / 42 bytes.
@@ -98,5 +100,5 @@ static_assert(sizeof(Globalstate_t) <= 64, "Do not cross cache lines with Global
 extern Globalstate_t Global;
 
 // Project includes.
-#include "Backend\AABackend.hpp"
-#include "Services\AAServices.hpp"
+#include "Backend/AABackend.hpp"
+#include "Services/AAServices.hpp"
@@ -48,13 +48,16 @@ namespace Services::Clientinfo
     {
         static bool __cdecl onLeave(uint64_t, const char *LongID, const char *, unsigned int)
         {
+            // Nothing is stored, the client left long ago.
+            if (Backend::Messageprocessing::isRebuilding()) return true;
+
             Backend::Notifications::Publish("Client::onLeave", va(R"({ "ClientID" : "%s" })", LongID).c_str());
             Clientcache.erase(LongID);
             return true;
         }
-        static bool __cdecl onUpdate(uint64_t Timestamp, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onUpdate(uint64_t Timestamp, const char *LongID, const JSON::Value_t &Message)
         {
-            const auto Parsed = fromJSON(std::string_view(Message, Length));
+            const auto Parsed = fromJSON(Message);
             const auto Client = Parsed.value_or(Client_t{});
 
             // Sanity-checking.
@@ -63,19 +66,19 @@ namespace Services::Clientinfo
             if (Clientcache.contains(LongID) && Clientcache[LongID]->Timestamp > Timestamp) [[unlikely]] return false;
 
             // Only save for later lookups if the client is indeed active (i.e. we are not just processing the backlog).
-            if (Timestamp > uint64_t((std::chrono::utc_clock::now() - std::chrono::minutes(5)).time_since_epoch().count()))
+            if (!Backend::Messageprocessing::isRebuilding() && Timestamp > uint64_t((std::chrono::utc_clock::now() - std::chrono::minutes(5)).time_since_epoch().count()))
                 Clientcache.emplace(LongID, std::make_shared<Client_t>(Client)).first->second->Timestamp = Timestamp;
 
             // Insert into the database.
             try
             {
-                Backend::Database()
-                    << "INSERT OR REPLACE INTO Clients VALUES (?,?,?,?,?);"
-                    << Client.Publickey
-                    << Client.GameID
-                    << Client.ModID
-                    << Client.Flags
-                    << Encoding::toNarrow(Client.Username);
+                auto &Statement = Backend::Messageprocessing::getStatement("INSERT OR REPLACE INTO Client VALUES (?,?,?,?,?);");
+                Statement << Client.Publickey
+                          << Client.GameID
+                          << Client.ModID
+                          << Client.Flags
+                          << Encoding::toNarrow(Client.Username);
+                Statement.execute();
             } catch (...) {}
 
             return true;
@@ -125,6 +128,42 @@ namespace Services::Clientinfo
 
             return JSON::Dump(Object);
         }
+
+        // Polled by plugins, so cached until the Client table changes.
+        static std::string __cdecl getClient(JSON::Value_t &&Request)
+        {
+            const auto ClientID = Request.value<std::string>("ClientID");
+            if (ClientID.empty()) [[unlikely]] return R"({ "Error" : "Missing ClientID." })";
+
+            if (const auto Client = AyriaAPI::Clientinfo::Find(ClientID)) return JSON::Dump(Client);
+            return R"({ "Error" : "Unknown client." })";
+        }
+    }
+
+    // Fixed-shape calls that games make often, without the JSON round-trip.
+    namespace BinaryAPI
+    {
+        static bool __cdecl setGameinfo(Bytebuffer &Arguments, Bytebuffer &)
+        {
+            Global.GameID = Arguments.Read<uint32_t>();
+            Global.ModID = Arguments.Read<uint32_t>();
+            triggerUpdate();
+            return true;
+        }
+        static bool __cdecl setGamestate(Bytebuffer &Arguments, Bytebuffer &)
+        {
+            Global.Settings.isHosting = Arguments.Read<bool>();
+            Global.Settings.isIngame = Arguments.Read<bool>();
+            triggerUpdate();
+            return true;
+        }
+        static bool __cdecl setSocialstate(Bytebuffer &Arguments, Bytebuffer &)
+        {
+            Global.Settings.isPrivate = Arguments.Read<bool>();
+            Global.Settings.isAway = Arguments.Read<bool>();
+            triggerUpdate();
+            return true;
+        }
     }
 
     // Layer 4 interaction.
@@ -169,14 +208,20 @@ namespace Services::Clientinfo
         } catch (...) {}
 
         // Parse Layer 2 messages.
-        Backend::Messageprocessing::addMessagehandler("Client::Leave", Messagehandlers::onLeave);
-        Backend::Messageprocessing::addMessagehandler("Client::Update", Messagehandlers::onUpdate);
+        Backend::Messageprocessing::addMessagehandler("Client::Leave", Messagehandlers::onLeave, true);
+        Backend::Messageprocessing::addMessagehandler("Client::Update", Messagehandlers::onUpdate, true);
+        Backend::Messageprocessing::addCompactionpolicy("Client::Update");
+        Backend::Messageprocessing::addDerivedtable("Client");
 
         // Accept Layer 3 calls.
         Backend::JSONAPI::addEndpoint("Client::setGameinfo", JSONAPI::setGameinfo);
         Backend::JSONAPI::addEndpoint("Client::setGamestate", JSONAPI::setGamestate);
         Backend::JSONAPI::addEndpoint("Client::setSocialstate", JSONAPI::setSocialstate);
+        Backend::BinaryAPI::addEndpoint("Client::setGameinfo", { { "GameID", BB_UINT32 }, { "ModID", BB_UINT32 } }, BinaryAPI::setGameinfo);
+        Backend::BinaryAPI::addEndpoint("Client::setGamestate", { { "isHosting", BB_BOOL }, { "isIngame", BB_BOOL } }, BinaryAPI::setGamestate);
+        Backend::BinaryAPI::addEndpoint("Client::setSocialstate", { { "isPrivate", BB_BOOL }, { "isAway", BB_BOOL } }, BinaryAPI::setSocialstate);
         Backend::JSONAPI::addEndpoint("Client::getLocalclient", JSONAPI::getLocalclient);
+        Backend::JSONAPI::addEndpoint("Client::getClient", JSONAPI::getClient, { "Client" });
 
         // Process Layer 4 notifications.
         Backend::Notifications::addProcessor("Client", Notifications::onUpdate);
@@ -65,9 +65,8 @@ namespace Services::Groups
     // Layer 2 interaction.
     namespace Messagehandlers
     {
-        static bool __cdecl onJoin(uint64_t, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onJoin(uint64_t, const char *LongID, const JSON::Value_t &Request)
         {
-            const auto Request = JSON::Parse(std::string_view(Message, Length));
             const auto MemberID = Request.value<std::string>("MemberID");
             const auto isModerator = Request.value<bool>("isModerator");
             const auto GroupID = Request.value<std::string>("GroupID");
@@ -99,9 +98,8 @@ namespace Services::Groups
 
             return true;
         }
-        static bool __cdecl onLeave(uint64_t, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onLeave(uint64_t, const char *LongID, const JSON::Value_t &Request)
         {
-            const auto Request = JSON::Parse(std::string_view(Message, Length));
             const auto MemberID = Request.value<std::string>("MemberID");
             const auto GroupID = Request.value<std::string>("GroupID");
             const auto Group = getGroup(GroupID);
@@ -136,9 +134,8 @@ namespace Services::Groups
             } catch (...) {}
             return true;
         }
-        static bool __cdecl onUpdate(uint64_t, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onUpdate(uint64_t, const char *LongID, const JSON::Value_t &Request)
         {
-            const auto Request = JSON::Parse(std::string_view(Message, Length));
             const auto Groupname = Request.value<std::string>("Groupname");
             const auto GroupID = Request.value<std::string>("GroupID");
             const auto isPublic = Request.value<bool>("isPublic");
@@ -162,8 +159,10 @@ namespace Services::Groups
                 Entry->isPublic = isPublic;
                 Entry->isFull = isFull;
 
+                // Membercount is maintained by the triggers, so update rather than replace the row.
                 Backend::Database()
-                    << "INSERT OR REPLACE INTO Group VALUES(?,?,?,?);"
+                    << "INSERT INTO \"Group\" (GroupID, Groupname, isPublic, isFull) VALUES (?,?,?,?) "
+                       "ON CONFLICT (GroupID) DO UPDATE SET Groupname = excluded.Groupname, isPublic = excluded.isPublic, isFull = excluded.isFull;"
                     << GroupID << Groupname << isPublic << isFull;
 
                 if (isPublic)
@@ -183,7 +182,7 @@ namespace Services::Groups
             try
             {
                 Backend::Database()
-                    << "DELETE FROM Group WHERE GroupID = ?;"
+                    << "DELETE FROM \"Group\" WHERE GroupID = ?;"
                     << std::string(LongID);
             } catch (...) {};
             return true;
@@ -259,6 +258,21 @@ namespace Services::Groups
             Layer1::Publish("Group::Destroy", JSON::Dump(Request));
             return {};
         }
+
+        // Read-only, cached until the Groupmember table changes.
+        static std::string __cdecl getMembers(JSON::Value_t &&Request)
+        {
+            const auto GroupID = Request.value<std::string>("GroupID");
+            if (GroupID.empty()) [[unlikely]] return R"({ "Error" : "Missing GroupID." })";
+
+            const auto Object = JSON::Object_t({
+                { "Moderators", AyriaAPI::Groups::getModerators(GroupID) },
+                { "Members", AyriaAPI::Groups::getMembers(GroupID) },
+                { "GroupID", GroupID }
+            });
+
+            return JSON::Dump(Object);
+        }
     }
 
     // Layer 4 interaction.
@@ -269,7 +283,7 @@ namespace Services::Groups
             try
             {
                 Backend::Database()
-                    << "SELECT * FROM Group WHERE rowid = ?;" << RowID
+                    << "SELECT * FROM \"Group\" WHERE rowid = ?;" << RowID
                     >> [](const std::string &GroupID, const std::string &Groupname, bool isPublic, bool isFull, uint32_t Membercount)
                     {
                         if (!getMembers(GroupID).contains(Global.getLongID())) return;
@@ -316,7 +330,7 @@ namespace Services::Groups
         try
         {
             Backend::Database() <<
-                "CREATE TABLE IF NOT EXISTS Group ("
+                "CREATE TABLE IF NOT EXISTS \"Group\" ("
                 "GroupID TEXT PRIMARY KEY REFERENCES Account(Publickey) ON DELETE CASCADE, "
                 "Groupname TEXT NOT NULL, "
                 "isPublic BOOLEAN, "
@@ -326,7 +340,7 @@ namespace Services::Groups
             Backend::Database() <<
                 "CREATE TABLE IF NOT EXISTS Groupmember ("
                 "MemberID TEXT REFERENCES Account(Publickey) ON DELETE CASCADE, "
-                "GroupID TEXT REFERENCES Group(GroupID) ON DELETE CASCADE, "
+                "GroupID TEXT REFERENCES \"Group\"(GroupID) ON DELETE CASCADE, "
                 "isModerator BOOLEAN DEFAULT false, "
                 "UNIQUE (GroupID, MemberID) );";
 
@@ -334,7 +348,7 @@ namespace Services::Groups
                 "CREATE TRIGGER IF NOT EXISTS MemberINC "
                 "AFTER INSERT ON Groupmember "
                 "BEGIN "
-                "UPDATE Group SET Membercount = (Membercount + 1) "
+                "UPDATE \"Group\" SET Membercount = (Membercount + 1) "
                 "WHERE GroupID = new.GroupID; "
                 "END;";
 
@@ -342,17 +356,19 @@ namespace Services::Groups
                 "CREATE TRIGGER IF NOT EXISTS MemberDEC "
                 "AFTER DELETE ON Groupmember "
                 "BEGIN "
-                "UPDATE Group SET Membercount = (Membercount - 1) "
+                "UPDATE \"Group\" SET Membercount = (Membercount - 1) "
                 "WHERE GroupID = old.GroupID; "
                 "END;";
 
         } catch (...) {}
 
         // Parse Layer 2 messages.
-        Backend::Messageprocessing::addMessagehandler("Group::Join", Messagehandlers::onJoin);
-        Backend::Messageprocessing::addMessagehandler("Group::Leave", Messagehandlers::onLeave);
-        Backend::Messageprocessing::addMessagehandler("Group::Update", Messagehandlers::onUpdate);
-        Backend::Messageprocessing::addMessagehandler("Group::Destroy", Messagehandlers::onDestroy);
+        Backend::Messageprocessing::addMessagehandler("Group::Join", Messagehandlers::onJoin, true);
+        Backend::Messageprocessing::addMessagehandler("Group::Leave", Messagehandlers::onLeave, true);
+        Backend::Messageprocessing::addMessagehandler("Group::Update", Messagehandlers::onUpdate, true);
+        Backend::Messageprocessing::addMessagehandler("Group::Destroy", Messagehandlers::onDestroy, true);
+        Backend::Messageprocessing::addDerivedtable("Groupmember");
+        Backend::Messageprocessing::addDerivedtable("Group");
 
         // Accept Layer 3 calls.
         Backend::JSONAPI::addEndpoint("Groups::Join", JSONAPI::onJoin);
@@ -362,6 +378,7 @@ namespace Services::Groups
         Backend::JSONAPI::addEndpoint("Groups::Updategroup", JSONAPI::onUpdate);
         Backend::JSONAPI::addEndpoint("Groups::Creategroup", JSONAPI::onUpdate);
         Backend::JSONAPI::addEndpoint("Groups::Destroygroup", JSONAPI::onDestroy);
+        Backend::JSONAPI::addEndpoint("Groups::getMembers", JSONAPI::getMembers, { "Groupmember" });
 
         // Process Layer 4 notifications.
         Backend::Notifications::addProcessor("Group", Notifications::onGroupupdate);
@@ -11,21 +11,21 @@ namespace Services::Matchmaking
     // Layer 2 interaction.
     namespace Messagehandlers
     {
-        static bool __cdecl onUpdate(uint64_t Timestamp, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onUpdate(uint64_t Timestamp, const char *LongID, const JSON::Value_t &Message)
         {
-            const auto Server = fromJSON(std::string_view(Message, Length));
+            const auto Server = fromJSON(Message);
             if (!Server || Server->GroupID != LongID) [[unlikely]] return false;
 
             try
             {
-                Backend::Database()
-                    << "INSERT OR REPLACE INTO Matchmaking VALUES (?,?,?,?,?,?,?);"
-                    << Server->GroupID
-                    << Server->Hostaddress
-                    << Server->Servername
-                    << Server->Provider
-                    << Server->GameID
-                    << Server->ModID;
+                auto &Statement = Backend::Messageprocessing::getStatement("INSERT OR REPLACE INTO Matchmaking VALUES (?,?,?,?,?,?,?);");
+                Statement << Server->GroupID
+                          << Server->Hostaddress
+                          << Server->Servername
+                          << Server->Provider
+                          << Server->GameID
+                          << Server->ModID;
+                Statement.execute();
             } catch (...) {}
 
             return true;
@@ -109,7 +109,7 @@ namespace Services::Matchmaking
         {
             Backend::Database() <<
                 "CREATE TABLE IF NOT EXISTS Matchmaking ("
-                "GroupID TEXT PRIMARY KEY REFERENCES Group(GroupID) ON DELETE CASCADE, "
+                "GroupID TEXT PRIMARY KEY REFERENCES \"Group\"(GroupID) ON DELETE CASCADE, "
                 "Hostaddress TEXT NOT NULL, "
                 "Servername TEXT, "
                 "Provider TEXT NOT NULL, "
@@ -119,7 +119,9 @@ namespace Services::Matchmaking
 
         // Parse Layer 2 messages.
         Backend::Messageprocessing::addMessagehandler("Matchmaking::Update", Messagehandlers::onUpdate);
-        Backend::Messageprocessing::addMessagehandler("Matchmaking::Stop", Messagehandlers::onTerminate);
+        Backend::Messageprocessing::addMessagehandler("Matchmaking::Stop", Messagehandlers::onTerminate, true);
+        Backend::Messageprocessing::addCompactionpolicy("Matchmaking::Update");
+        Backend::Messageprocessing::addDerivedtable("Matchmaking");
 
         // Accept Layer 3 calls.
         Backend::JSONAPI::addEndpoint("Matchmaking::updateServer", JSONAPI::updateServer);
@@ -88,9 +88,8 @@ namespace Services::Messaging
     // Layer 2 interaction.
     namespace Messagehandlers
     {
-        static bool __cdecl onKeychange(uint64_t, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onKeychange(uint64_t, const char *LongID, const JSON::Value_t &Request)
         {
-            const auto Request = JSON::Parse(Message, Length);
             const auto Newkey = Request.value<std::string>("Newkey");
             const auto Checksum = Request.value<uint32_t>("Checksum");
             const auto GroupID = Request.value<std::string>("GroupID");
@@ -112,9 +111,8 @@ namespace Services::Messaging
 
             return true;
         }
-        static bool __cdecl onUsermessage(uint64_t Timestamp, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onUsermessage(uint64_t Timestamp, const char *LongID, const JSON::Value_t &Request)
         {
-            const auto Request = JSON::Parse(Message, Length);
             const auto UserID = Request.value<std::string>("UserID");
             const auto Checksum = Request.value<uint32_t>("Checksum");
             const auto Payload = Request.value<std::string>("Payload");
@@ -163,9 +161,8 @@ namespace Services::Messaging
 
             return true;
         }
-        static bool __cdecl onGroupmessage(uint64_t Timestamp, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onGroupmessage(uint64_t Timestamp, const char *LongID, const JSON::Value_t &Request)
         {
-            const auto Request = JSON::Parse(Message, Length);
             const auto Checksum = Request.value<uint32_t>("Checksum");
             const auto GroupID = Request.value<std::string>("GroupID");
             const auto Payload = Request.value<std::string>("Payload");
@@ -383,7 +380,7 @@ namespace Services::Messaging
         {
             Backend::Database() <<
                 "CREATE TABLE IF NOT EXISTS Groupkey ("
-                "GroupID TEXT PRIMARY KEY REFERENCES Group(GroupID) ON DELETE CASCADE, "
+                "GroupID TEXT PRIMARY KEY REFERENCES \"Group\"(GroupID) ON DELETE CASCADE, "
                 "Encryptionkey TEXT NOT NULL);";
 
             Backend::Database() <<
@@ -400,7 +397,7 @@ namespace Services::Messaging
             Backend::Database() <<
                 "CREATE TABLE IF NOT EXISTS Groupmessages ("
                 "Source TEXT REFERENCES Account(Publickey) ON DELETE CASCADE, "
-                "Target TEXT REFERENCES Group(GroupID) ON DELETE CASCADE, "
+                "Target TEXT REFERENCES \"Group\"(GroupID) ON DELETE CASCADE, "
                 "Messagetype INTEGER, "
                 "Checksum INTEGER, "
                 "Received INTEGER, "
@@ -411,9 +408,9 @@ namespace Services::Messaging
         } catch (...) {}
 
         // Parse Layer 2 messages.
-        Backend::Messageprocessing::addMessagehandler("Group::reKey", Messagehandlers::onKeychange);
-        Backend::Messageprocessing::addMessagehandler("Usermessage", Messagehandlers::onUsermessage);
-        Backend::Messageprocessing::addMessagehandler("Groupmessage", Messagehandlers::onGroupmessage);
+        Backend::Messageprocessing::addMessagehandler("Group::reKey", Messagehandlers::onKeychange, true);
+        Backend::Messageprocessing::addMessagehandler("Usermessage", Messagehandlers::onUsermessage, true);
+        Backend::Messageprocessing::addMessagehandler("Groupmessage", Messagehandlers::onGroupmessage, true);
 
         // Accept Layer 3 calls.
         Backend::JSONAPI::addEndpoint("Group::Invite", JSONAPI::groupInvite);
@@ -20,9 +20,9 @@ namespace Services::Presence
     // Layer 2 interaction.
     namespace Messagehandlers
     {
-        static bool __cdecl onInsert(uint64_t, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onInsert(uint64_t, const char *LongID, const JSON::Value_t &Message)
         {
-            const JSON::Array_t Request = JSON::Parse(std::string_view(Message, Length));
+            const JSON::Array_t Request = Message;
 
             for (const auto &Item : Request)
             {
@@ -34,17 +34,17 @@ namespace Services::Presence
 
                 try
                 {
-                    Backend::Database()
-                        << "INSERT OR REPLACE INTO Presence VALUES (?,?,?,?);"
-                        << std::string(LongID) << Item.value<std::string>("Category") << Item.value<std::string>("Key") << Value;
+                    auto &Statement = Backend::Messageprocessing::getStatement("INSERT OR REPLACE INTO Presence VALUES (?,?,?,?);");
+                    Statement << std::string(LongID) << Item.value<std::string>("Category") << Item.value<std::string>("Key") << Value;
+                    Statement.execute();
                 } catch (...) {}
             }
 
             return !Request.empty();
         }
-        static bool __cdecl onErase(uint64_t, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onErase(uint64_t, const char *LongID, const JSON::Value_t &Message)
         {
-            const JSON::Array_t Request = JSON::Parse(std::string_view(Message, Length));
+            const JSON::Array_t Request = Message;
 
             try
             {
@@ -61,6 +61,23 @@ namespace Services::Presence
 
             return !Request.empty();
         }
+
+        // An insert is superseded by a newer one that sets the same (Category, Key) pairs.
+        static std::string __cdecl getKey(const char *Message, unsigned int Length)
+        {
+            const JSON::Array_t Request = JSON::Parse(std::string_view(Message, Length));
+            std::set<std::string> Keys{};
+
+            for (const auto &Item : Request)
+            {
+                if (!Item.contains_all("Key", "Category")) [[unlikely]] continue;
+                Keys.insert(Item.value<std::string>("Category") + '\0' + Item.value<std::string>("Key"));
+            }
+
+            std::string Result{};
+            for (const auto &Key : Keys) Result.append(Key).push_back('\n');
+            return Result;
+        }
     }
 
     // Layer 3 interaction.
@@ -100,6 +117,53 @@ namespace Services::Presence
 
             return {};
         }
+
+        // Read-only, cached until the Presence table changes.
+        static std::string __cdecl getPresence(JSON::Value_t &&Request)
+        {
+            const auto ClientID = Request.value<std::string>("ClientID");
+            const auto Category = Request.value<std::string>("Category");
+            if (ClientID.empty() || Category.empty()) [[unlikely]] return R"({ "Error" : "Missing ClientID or Category." })";
+
+            if (const auto Presence = AyriaAPI::Presence::Dump(ClientID, Category)) return JSON::Dump(JSON::Value_t(*Presence));
+            return {};
+        }
+    }
+
+    // Single inserts are the common case for games, so skip the JSON request.
+    namespace BinaryAPI
+    {
+        // The message is written straight from the arguments rather than through a JSON::Object_t.
+        static void Appendstring(std::string &Payload, std::string_view Name, std::string_view Value)
+        {
+            Payload.append(va("\"%.*s\" : \"", int(Name.size()), Name.data()));
+            for (const auto Char : Value)
+            {
+                if (Char == '"' || Char == '\\') Payload.push_back('\\');
+                if (uint8_t(Char) < 0x20) [[unlikely]] { Payload.append(va("\\u%04X", uint8_t(Char))); continue; }
+                Payload.push_back(Char);
+            }
+            Payload.push_back('"');
+        }
+
+        static bool __cdecl Insert(Bytebuffer &Arguments, Bytebuffer &)
+        {
+            const auto Category = Arguments.Read<std::string>();
+            const auto Key = Arguments.Read<std::string>();
+            const auto Value = Arguments.Read<std::string>();
+
+            std::string Payload{};
+            Payload.reserve(48 + Category.size() + Key.size() + Value.size());
+
+            Payload.append("[ { ");
+            Appendstring(Payload, "Category", Category); Payload.append(", ");
+            Appendstring(Payload, "Key", Key); Payload.append(", ");
+            Appendstring(Payload, "Value", Value);
+            Payload.append(" } ]");
+
+            Backend::Messagebus::Publish("Presence::Insert", Payload);
+            return true;
+        }
     }
 
     // Layer 4 interaction.
@@ -140,10 +204,14 @@ namespace Services::Presence
         // Parse Layer 2 messages.
         Backend::Messageprocessing::addMessagehandler("Presence::Insert", Messagehandlers::onInsert);
         Backend::Messageprocessing::addMessagehandler("Presence::Erase", Messagehandlers::onErase);
+        Backend::Messageprocessing::addCompactionpolicy("Presence::Insert", Messagehandlers::getKey);
+        Backend::Messageprocessing::addDerivedtable("Presence");
 
         // Accept Layer 3 calls.
         Backend::JSONAPI::addEndpoint("Presence::Insert", JSONAPI::Insert);
         Backend::JSONAPI::addEndpoint("Presence::Erase", JSONAPI::Erase);
+        Backend::JSONAPI::addEndpoint("Presence::getPresence", JSONAPI::getPresence, { "Presence" });
+        Backend::BinaryAPI::addEndpoint("Presence::Insert", { { "Category", BB_ASCIISTRING }, { "Key", BB_ASCIISTRING }, { "Value", BB_ASCIISTRING } }, BinaryAPI::Insert);
 
         // Process Layer 4 notifications.
         Backend::Notifications::addProcessor("Relation", Notifications::onUpdate);
@@ -11,22 +11,28 @@ namespace Services::Relations
     // Layer 2 interaction.
     namespace Messagehandlers
     {
-        static bool __cdecl onUpdate(uint64_t, const char *LongID, const char *Message, unsigned int Length)
+        static bool __cdecl onUpdate(uint64_t, const char *LongID, const JSON::Value_t &Request)
         {
             // We don't accept deltas, we need all the properties.
-            const auto Request = JSON::Parse(std::string_view(Message, Length));
             if (!Request.contains_all("Target", "isFriend", "isBlocked")) [[unlikely]] return false;
 
             try
             {
-                Backend::Database()
-                    << "INSERT OR REPLACE INTO Relation VALUES (?,?,?,?);"
-                    << std::string(LongID) << Request.value<std::string>("Target")
-                    << Request.value<bool>("isBlocked") << Request.value<bool>("isFriend");
+                auto &Statement = Backend::Messageprocessing::getStatement("INSERT OR REPLACE INTO Relation VALUES (?,?,?,?);");
+                Statement << std::string(LongID) << Request.value<std::string>("Target")
+                          << Request.value<bool>("isBlocked") << Request.value<bool>("isFriend");
+                Statement.execute();
             } catch (...) {}
 
             return true;
         }
+
+        // Only the latest update per target matters.
+        static std::string __cdecl getKey(const char *Message, unsigned int Length)
+        {
+            const auto Request = JSON::Parse(std::string_view(Message, Length));
+            return Request.value<std::string>("Target");
+        }
     }
 
     // Layer 3 interaction.
@@ -123,6 +129,8 @@ namespace Services::Relations
 
         // Parse Layer 2 messages.
         Backend::Messageprocessing::addMessagehandler("Relation::Update", Messagehandlers::onUpdate);
+        Backend::Messageprocessing::addCompactionpolicy("Relation::Update", Messagehandlers::getKey);
+        Backend::Messageprocessing::addDerivedtable("Relation");
 
         // Accept Layer 3 calls.
         Backend::JSONAPI::addEndpoint("Relation::Clear", JSONAPI::Clear);
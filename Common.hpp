@@ -22,6 +22,12 @@
 #error Compiling for unknown platform.
 #endif
 
+// Calling conventions only matter for x86 Windows.
+#if !defined(_WIN32) && !defined(__cdecl)
+#define __cdecl
+#define __stdcall
+#endif
+
 // Remove some Windows annoyance.
 #if defined(_WIN32)
 #define _HAS_DEPRECATED_RESULT_OF 1
@@ -13,9 +13,11 @@
 #pragma warning(push, 0)
 
 // Standard-library includes for all projects in this repository.
+#include <condition_variable>
 #include <memory_resource>
 #include <unordered_map>
 #include <unordered_set>
+#include <shared_mutex>
 #include <string_view>
 #include <filesystem>
 #include <functional>
@@ -26,6 +28,7 @@
 #include <cassert>
 #include <cstdint>
 #include <numbers>
+#include <random>
 #include <atomic>
 #include <bitset>
 #include <chrono>
@@ -38,6 +41,7 @@
 #include <thread>
 #include <vector>
 #include <array>
+#include <deque>
 #include <mutex>
 #include <queue>
 #include <regex>
@@ -56,17 +60,71 @@
 #include <intrin.h>
 #include <direct.h>
 #else
+#include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <netinet/tcp.h>
+#include <netinet/in.h>
+#include <immintrin.h>
+#include <arpa/inet.h>
+#include <signal.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <netdb.h>
 #include <dlfcn.h>
+#include <errno.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#endif
 #endif
 
 // Restore warnings.
 #pragma warning(pop)
 
+// Winsock and Win32 names for their POSIX equivalents, so that the backend can be shared.
+#if !defined(_WIN32)
+using SOCKET = int;
+using PSOCKADDR = sockaddr *;
+using WSADATA = struct { int Unused; };
+constexpr int INVALID_SOCKET = -1, SOCKET_ERROR = -1;
+
+#define MAKEWORD(Low, High) uint16_t((uint8_t(High) << 8) | uint8_t(Low))
+#define WSAEWOULDBLOCK EWOULDBLOCK
+#define ioctlsocket ioctl
+#define closesocket close
+
+inline int WSAStartup(uint16_t, WSADATA *) { return 0; }
+inline int WSAGetLastError() { return errno; }
+
+inline uint64_t GetTickCount64()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+inline const char *GetCommandLineA()
+{
+    static std::string Commandline = []()
+    {
+        // Arguments are null-separated.
+        std::string Result{};
+        if (const auto Filehandle = std::fopen("/proc/self/cmdline", "rb"))
+        {
+            char Buffer[1024]; size_t Read;
+            while ((Read = std::fread(Buffer, 1, sizeof(Buffer), Filehandle))) Result.append(Buffer, Read);
+            std::fclose(Filehandle);
+        }
+
+        std::ranges::replace(Result, '\0', ' ');
+        return Result;
+    }();
+
+    return Commandline.c_str();
+}
+#endif
+
 // Third-party includes, usually included via VCPKG.
 #include "Thirdparty.hpp"
 
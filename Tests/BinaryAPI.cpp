@@ -0,0 +1,130 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+*/
+
+#include "Testing.hpp"
+#include <Global.hpp>
+using namespace Backend;
+
+// The export that plugins call, as declared by the generated header.
+extern "C" const void *__cdecl BinaryRequest(unsigned int FunctionID, const void *Arguments, unsigned int Length, unsigned int *Resultlength);
+
+// Same layout as AYA_Writetyped and AYA_Writeblob in the generated header.
+static void Writetyped(std::string &Buffer, uint8_t Type, const void *Data, size_t Size)
+{
+    Buffer.push_back(char(Type));
+    Buffer.append((const char *)Data, Size);
+}
+static std::string Encode(bool Flag, uint32_t ID, const char *Name, std::string_view Data)
+{
+    std::string Buffer{};
+    const auto Length = uint32_t(Data.size());
+
+    Writetyped(Buffer, BB_BOOL, &Flag, sizeof(Flag));
+    Writetyped(Buffer, BB_UINT32, &ID, sizeof(ID));
+    Writetyped(Buffer, BB_ASCIISTRING, Name, std::strlen(Name) + 1);
+    Buffer.push_back(char(BB_BLOB));
+    Writetyped(Buffer, BB_UINT32, &Length, sizeof(Length));
+    Buffer.append(Data);
+    return Buffer;
+}
+
+// Echoes the arguments back in reverse order.
+static bool __cdecl Echo(Bytebuffer &Arguments, Bytebuffer &Result)
+{
+    const auto Flag = Arguments.Read<bool>();
+    const auto ID = Arguments.Read<uint32_t>();
+    const auto Name = Arguments.Read<std::string>();
+    const auto Data = Arguments.Read<Blob>();
+
+    Result.Write(Data);
+    Result.Write(Name);
+    Result.Write(ID + 1);
+    Result.Write(!Flag);
+    return true;
+}
+static bool __cdecl Refuse(Bytebuffer &, Bytebuffer &) { return false; }
+static bool __cdecl Empty(Bytebuffer &, Bytebuffer &) { return true; }
+
+int main()
+{
+    BinaryAPI::addEndpoint("Test::Echo", { { "Flag", BB_BOOL }, { "ID", BB_UINT32 }, { "Name", BB_ASCIISTRING }, { "Data", BB_BLOB } }, Echo);
+    BinaryAPI::addEndpoint("Test::Refuse", {}, Refuse);
+    BinaryAPI::addEndpoint("Test::Empty", {}, Empty);
+    BinaryAPI::addEndpoint("Test::Null", {}, nullptr);
+    constexpr auto EchoID = Hash::WW32("Test::Echo");
+
+    // Arguments encoded like the header does are accepted, and the result decodes with a Bytebuffer.
+    {
+        const auto Arguments = Encode(true, 41, "Player", "\x00\x01\x02"sv);
+        unsigned int Resultlength{};
+
+        const auto Result = BinaryRequest(EchoID, Arguments.data(), unsigned(Arguments.size()), &Resultlength);
+        Check(Result != nullptr && Resultlength > 0);
+
+        if (Result)
+        {
+            Bytebuffer Decoded(Result, Resultlength);
+            Check(Decoded.Read<Blob>() == Blob{ 0, 1, 2 });
+            Check(Decoded.Read<std::string>() == "Player");
+            Check(Decoded.Read<uint32_t>() == 42);
+            Check(Decoded.Read<bool>() == false);
+            Check(Decoded.Internaliterator == Decoded.Internalsize);
+        }
+    }
+
+    // Anything that does not match the schema is refused before the handler sees it.
+    {
+        const auto Valid = Encode(false, 1, "A", "");
+        unsigned int Resultlength = 1;
+
+        auto Mistyped = Valid; Mistyped[2] = char(BB_SINT32);
+        Check(!BinaryRequest(EchoID, Mistyped.data(), unsigned(Mistyped.size()), &Resultlength));
+        Check(Resultlength == 0);
+
+        // Every truncation, including in the middle of the string and blob length.
+        for (size_t Size = 0; Size < Valid.size(); ++Size)
+            Check(!BinaryRequest(EchoID, Valid.data(), unsigned(Size), nullptr));
+
+        Check(BinaryRequest(EchoID, Valid.data(), unsigned(Valid.size()), nullptr));
+        Check(!BinaryRequest(Hash::WW32("Test::Missing"), Valid.data(), unsigned(Valid.size()), nullptr));
+        Check(!BinaryRequest(Hash::WW32("Test::Null"), nullptr, 0, nullptr));
+
+        // Handlers can refuse too, but an empty successful result is not NULL.
+        Check(!BinaryRequest(Hash::WW32("Test::Refuse"), nullptr, 0, nullptr));
+        Check(BinaryRequest(Hash::WW32("Test::Empty"), nullptr, 0, &Resultlength));
+        Check(Resultlength == 0);
+    }
+
+    // The header is generated from the registry and the Bytebuffer enum.
+    {
+        const auto Header = BinaryAPI::Generateheader();
+        const auto Contains = [&](std::string_view Needle) { return Header.find(Needle) != std::string::npos; };
+
+        Check(Contains("#define AYA_TYPE_BOOL 1\n"));
+        Check(Contains("#define AYA_TYPE_BLOB 15\n"));
+        Check(Contains("#define AYA_CALL __cdecl\n"));
+        Check(Contains("typedef const void *(AYA_CALL *AYA_BinaryRequest_t)("));
+        Check(Contains(va("#define AYA_ID_Test_Echo 0x%08XU\n", EchoID)));
+        Check(Contains(
+            "static inline unsigned int AYA_Encode_Test_Echo(uint8_t *Buffer, bool Flag, uint32_t ID, const char *Name, const uint8_t *Data, uint32_t DataLength)\n"
+            "{\n"
+            "    unsigned int Offset = 0;\n"
+            "    Offset = AYA_Writetyped(Buffer, Offset, AYA_TYPE_BOOL, &Flag, sizeof(Flag));\n"
+            "    Offset = AYA_Writetyped(Buffer, Offset, AYA_TYPE_UINT32, &ID, sizeof(ID));\n"
+            "    Offset = AYA_Writetyped(Buffer, Offset, AYA_TYPE_ASCIISTRING, Name, (unsigned int)strlen(Name) + 1);\n"
+            "    Offset = AYA_Writeblob(Buffer, Offset, Data, DataLength);\n"
+            "    return Offset;\n"
+            "}\n"));
+        Check(Contains("static inline unsigned int AYA_Encode_Test_Refuse(uint8_t *Buffer)\n"));
+
+        // Sorted by name and stable between runs, handlers without a callback are never registered.
+        Check(Header.find("// Test::Echo") < Header.find("// Test::Refuse"));
+        Check(!Contains("Test_Null"));
+        Check(Header == BinaryAPI::Generateheader());
+    }
+
+    return Testing::Failures;
+}
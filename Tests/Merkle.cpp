@@ -0,0 +1,76 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+*/
+
+#include "Testing.hpp"
+#include <Backend/Communication/Messagebus.hpp>
+using namespace Backend::Messagebus;
+
+static std::vector<std::string> getLeaves(size_t Count)
+{
+    std::vector<std::string> Result;
+    for (size_t i = 0; i < Count; ++i) Result.push_back(Merkle::Leaf("Message " + std::to_string(i)));
+    return Result;
+}
+
+int main()
+{
+    // Known answers, SHA256(0x00 || Data) for leaves and SHA256(0x01 || Left || Right) for nodes.
+    {
+        Check(Tohex(Merkle::Leaf("Message 0")) == "20f256caf6f977276d939434b41c81a1b5a4a040e96da252bc5f18dda89cddfc");
+
+        const auto Tree = Merkle::Build(getLeaves(5));
+        Check(Tree.size() == 4);
+        Check(Tohex(Tree.back().front()) == "b1b2725a2cef5168d929fc932f7db0206f5f84222f56697b29825c66d756753f");
+
+        // The odd leaf is paired with itself on every level.
+        Check(Tohex(Merkle::Proof(Tree, 4)) ==
+            "04000000"
+            "a7067d57a127a483cdaa1ffd115d7ae87a7bb451709f5dfe875fe68d73522c6b"
+            "44c5f7b317df0f5357e55993df8815c1ddb278c5b95c2df8b14e12e14e426f57"
+            "01326aa06db31bfe3125ff29d0b952232109522b0baa3a8fe2394c9893eaa666");
+    }
+
+    // A single message is its own root with an empty path.
+    {
+        const auto Tree = Merkle::Build(getLeaves(1));
+        const auto Proof = Merkle::Proof(Tree, 0);
+
+        Check(Proof.size() == sizeof(uint32_t));
+        Check(Merkle::Root("Message 0", Proof) == Tree.back().front());
+    }
+
+    // Every proof leads back to the root, and only for its own message.
+    for (const size_t Count : { 2, 3, 7, 8, 33 })
+    {
+        const auto Tree = Merkle::Build(getLeaves(Count));
+        const auto &Root = Tree.back().front();
+
+        for (uint32_t i = 0; i < Count; ++i)
+        {
+            const auto Proof = Merkle::Proof(Tree, i);
+            Check(Merkle::Root("Message " + std::to_string(i), Proof) == Root);
+            Check(Merkle::Root("Message " + std::to_string(i + 1), Proof) != Root);
+
+            // Claiming another position must not verify either.
+            auto Moved = Proof;
+            *(uint32_t *)Moved.data() = (i + 1) % Count;
+            Check(Merkle::Root("Message " + std::to_string(i), Moved) != Root);
+        }
+    }
+
+    // Inner nodes can't be passed off as messages, i.e. presenting the children as data with the shorter path.
+    {
+        const auto Tree = Merkle::Build(getLeaves(4));
+        const auto Shortproof = std::string(4, '\0') + Tree[1][1];
+        Check(Merkle::Root(Tree[0][0] + Tree[0][1], Shortproof) != Tree.back().front());
+    }
+
+    // Truncated proofs are malformed.
+    Check(!Merkle::Root("Message 0", "\x00\x00\x00"sv));
+    Check(!Merkle::Root("Message 0", std::string(4 + 31, '\0')));
+
+    return Testing::Failures;
+}
@@ -0,0 +1,152 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+*/
+
+#include "Testing.hpp"
+#include <Backend/Communication/Messagebus.hpp>
+using namespace Backend::Messagebus::Sync;
+
+// Sorted by timestamp like the DB returns them.
+static std::vector<Entry_t> getEntries(size_t Count, uint64_t Start, uint64_t End, uint64_t Seed)
+{
+    std::mt19937_64 Random(Seed);
+    std::vector<Entry_t> Result(Count);
+
+    for (size_t i = 0; i < Count; ++i) Result[i] = { int64_t(i), Start + Random() % (End - Start), Random() };
+    std::ranges::sort(Result, {}, &Entry_t::Timestamp);
+    return Result;
+}
+
+// Same descent as onRanges, but both peers are local; returns the IDs that would be exchanged.
+static void Reconcile(const Range_t &Theirs, std::span<const Entry_t> Ours, std::span<const Entry_t> Other, Hashset<uint64_t> &Exchanged)
+{
+    const auto Mine = getRange(Theirs.Start, Theirs.End, Ours);
+    if (Mine.Count == Theirs.Count && Mine.Fingerprint == Theirs.Fingerprint) return;
+
+    if (Mine.Count <= Leafthreshold || Theirs.Count <= Leafthreshold || Theirs.End - Theirs.Start < Splitcount)
+    {
+        for (const auto &Entry : Ours) if (Entry.Timestamp >= Theirs.Start && Entry.Timestamp < Theirs.End) Exchanged.insert(Entry.ID);
+        for (const auto &Entry : Other) if (Entry.Timestamp >= Theirs.Start && Entry.Timestamp < Theirs.End) Exchanged.insert(Entry.ID);
+        return;
+    }
+
+    for (const auto &Range : Split(Theirs.Start, Theirs.End, Other))
+        Reconcile(Range, Ours, Other, Exchanged);
+}
+
+int main()
+{
+    // Known layout, equal steps with the remainder in the last range.
+    {
+        const auto Ranges = Split(0, 100, {});
+        Check(Ranges.size() == Splitcount);
+        Check(Ranges[0].Start == 0 && Ranges[0].End == 6);
+        Check(Ranges[14].Start == 84 && Ranges[14].End == 90);
+        Check(Ranges[15].Start == 90 && Ranges[15].End == 100);
+
+        // Narrower than the split count, so one tick per range.
+        const auto Narrow = Split(10, 15, {});
+        Check(Narrow.size() == 5);
+        Check(Narrow.front().Start == 10 && Narrow.back().End == 15);
+        Check(std::ranges::all_of(Narrow, [](const Range_t &Range) { return Range.End - Range.Start == 1; }));
+    }
+
+    // Fingerprints are the XOR of the IDs in [Start, End).
+    {
+        const std::vector<Entry_t> Entries{ { 0, 10, 0x0F }, { 1, 20, 0xF0 }, { 2, 30, 0xFF00 } };
+        const auto Range = getRange(10, 30, Entries);
+        Check(Range.Count == 2 && Range.Fingerprint == 0xFF);
+        Check(getRange(31, 40, Entries).Count == 0);
+    }
+
+    // The sub-ranges tile the parent and merge back into its count and fingerprint.
+    for (const uint64_t Seed : { 1, 2, 3 })
+    {
+        const uint64_t Start = 1'000'000, End = Start + 86'400'000 + Seed;
+        const auto Entries = getEntries(5000, Start, End, Seed);
+        const auto Whole = getRange(Start, End, Entries);
+        const auto Ranges = Split(Start, End, Entries);
+
+        Check(!Ranges.empty() && Ranges.size() <= Splitcount);
+        Check(Ranges.front().Start == Start && Ranges.back().End == End);
+
+        Range_t Merged{ Start, End, 0, 0 };
+        for (size_t i = 0; i < Ranges.size(); ++i)
+        {
+            if (i) Check(Ranges[i].Start == Ranges[i - 1].End);
+            Merged.Count += Ranges[i].Count;
+            Merged.Fingerprint ^= Ranges[i].Fingerprint;
+        }
+
+        Check(Whole.Count == 5000);
+        Check(Merged.Count == Whole.Count && Merged.Fingerprint == Whole.Fingerprint);
+    }
+
+    // Two peers that differ in a few messages find exactly those, without listing everything.
+    {
+        const uint64_t Start = 0, End = 86'400'000;
+        auto Ours = getEntries(20000, Start, End, 42);
+        auto Theirs = Ours;
+
+        Hashset<uint64_t> Expected{};
+        for (const auto Index : { 17, 4000, 4001, 12345, 19999 })
+        {
+            Expected.insert(Ours[Index].ID);
+            Ours[Index].ID = 0;
+        }
+        std::erase_if(Ours, [](const Entry_t &Entry) { return Entry.ID == 0; });
+        Theirs.push_back({ 0, End - 1, 0x1234 }); Expected.insert(0x1234);
+
+        Hashset<uint64_t> Exchanged{};
+        for (const auto &Range : Split(Start, End, Theirs)) Reconcile(Range, Ours, Theirs, Exchanged);
+
+        Check(std::ranges::all_of(Expected, [&](uint64_t ID) { return Exchanged.contains(ID); }));
+        Check(Exchanged.size() < 6 * Leafthreshold * 2);
+    }
+
+    // ID lists are cut between timestamps, and every chunk only lists its own sub-range.
+    {
+        const uint64_t Start = 0, End = 10000;
+        const auto Entries = getEntries(3000, Start, End, 7);
+        const auto Chunks = Chunkentries(Start, End, Entries, 100);
+
+        Check(Chunks.front().Start == Start && Chunks.back().End == End);
+        size_t Listed{};
+
+        for (size_t i = 0; i < Chunks.size(); ++i)
+        {
+            const auto &Chunk = Chunks[i];
+            if (i) Check(Chunk.Start == Chunks[i - 1].End);
+
+            Check(Chunk.Entries.size() <= 100);
+            Check(std::ranges::all_of(Chunk.Entries, [&](const Entry_t &Entry) { return Entry.Timestamp >= Chunk.Start && Entry.Timestamp < Chunk.End; }));
+            Listed += Chunk.Entries.size();
+        }
+
+        // With ~3 entries per timestamp nothing needs to be skipped.
+        Check(Listed == Entries.size());
+    }
+
+    // A timestamp with more entries than fit a chunk is listed partially, the rest is left to the peers reply.
+    {
+        std::vector<Entry_t> Entries{ { 0, 5, 1 } };
+        for (int i = 0; i < 10; ++i) Entries.push_back({ i + 1, 7, uint64_t(100 + i) });
+        Entries.push_back({ 11, 9, 2 });
+
+        const auto Chunks = Chunkentries(0, 20, Entries, 4);
+        Check(Chunks.size() == 3);
+        Check(Chunks[0].Start == 0 && Chunks[0].End == 7 && Chunks[0].Entries.size() == 1);
+        Check(Chunks[1].Start == 7 && Chunks[1].End == 8 && Chunks[1].Entries.size() == 4);
+        Check(Chunks[2].Start == 8 && Chunks[2].End == 20 && Chunks[2].Entries.size() == 1);
+    }
+
+    // Empty ranges still produce one chunk, so the peer learns that we have nothing.
+    {
+        const auto Chunks = Chunkentries(50, 60, {}, 4);
+        Check(Chunks.size() == 1 && Chunks[0].Start == 50 && Chunks[0].End == 60 && Chunks[0].Entries.empty());
+    }
+
+    return Testing::Failures;
+}
@@ -0,0 +1,70 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+*/
+
+#include "Testing.hpp"
+#include <Backend/Communication/Messagebus.hpp>
+using namespace Backend::Messagebus;
+
+// Compress with one end of the link and decompress with the other.
+static std::optional<std::string> Roundtrip(Streamencoder_t &Encoder, Streamdecoder_t &Decoder, std::string_view Input, size_t *Compressedsize = nullptr)
+{
+    std::string Compressed(LZ4_COMPRESSBOUND(int(Input.size())), '\0');
+    Compressed.resize(Encoder.Compress(Input, Compressed.data()));
+    if (Compressedsize) *Compressedsize = Compressed.size();
+
+    const auto Result = Decoder.Decompress(Compressed);
+    if (!Result) return {};
+    return std::string(*Result);
+}
+
+int main()
+{
+    // Repeated small messages should reference the earlier ones.
+    {
+        Streamencoder_t Encoder{}; Streamdecoder_t Decoder{};
+        const auto Message = R"({"Messagetype":"Clientinfo::Update","Username":"Player","GameID":1234,"isHosting":false})"s;
+        size_t First{}, Second{};
+
+        Check(Roundtrip(Encoder, Decoder, Message, &First) == Message);
+        Check(Roundtrip(Encoder, Decoder, Message, &Second) == Message);
+        Check(Second < First / 4);
+    }
+
+    // Mixed sizes up to the limit, enough to wrap both rings many times.
+    {
+        Streamencoder_t Encoder{}; Streamdecoder_t Decoder{};
+        std::mt19937_64 Random(1337);
+
+        for (size_t i = 0; i < 2000; ++i)
+        {
+            const auto Size = (i % 50 == 0) ? Maxblocksize : size_t(Random() % ((i % 7 == 0) ? Maxblocksize : 512));
+            std::string Message(Size, '\0');
+
+            // Half compressible text, half noise.
+            for (size_t c = 0; c < Size; ++c)
+                Message[c] = (c & 64) ? char(Random()) : char('a' + (c + i) % 13);
+
+            const auto Result = Roundtrip(Encoder, Decoder, Message);
+            Check(Result == Message);
+            if (Result != Message) break;
+        }
+    }
+
+    // The decoder must refuse frames that reference history it never saw.
+    {
+        Streamencoder_t Encoder{}; Streamdecoder_t Decoder{}, Fresh{};
+        const auto Message = std::string(4096, 'A');
+
+        (void)Roundtrip(Encoder, Decoder, Message);
+        std::string Compressed(LZ4_COMPRESSBOUND(int(Message.size())), '\0');
+        Compressed.resize(Encoder.Compress(Message, Compressed.data()));
+
+        Check(!Fresh.Decompress(Compressed));
+        Check(!Decoder.Decompress("\xFF\xFF\xFF\xFF"sv));
+    }
+
+    return Testing::Failures;
+}
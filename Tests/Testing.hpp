@@ -0,0 +1,34 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+
+    Minimal harness, each test is its own executable and returns the number of failed checks.
+*/
+
+#pragma once
+#include <Stdinclude.hpp>
+
+namespace Testing
+{
+    inline int Failures{};
+}
+
+// Variadic so that conditions can contain braced initializers.
+#define Check(...) do { \
+    if (!(__VA_ARGS__)) { std::fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__); Testing::Failures++; } } while (false)
+
+// Known answers are written as hex to keep them readable.
+inline std::string Tohex(std::string_view Input)
+{
+    constexpr auto Digits = "0123456789abcdef";
+    std::string Result; Result.reserve(Input.size() * 2);
+
+    for (const auto Byte : Input)
+    {
+        Result += Digits[uint8_t(Byte) >> 4];
+        Result += Digits[uint8_t(Byte) & 0xF];
+    }
+
+    return Result;
+}
@@ -0,0 +1,204 @@
+/*
+    Initial author: Convery (tcn@ayria.se)
+    Started: 2026-10-17
+    License: MIT
+
+    Also built with QDSA_BYTEARITHMETIC, so both backends are held to the same known answers.
+*/
+
+#include "Testing.hpp"
+using namespace qDSA;
+
+// From the byte-wise backend, Seed[i] = n * 31 + i * 7 and Message = "Message n".
+struct Vector_t { std::string_view Publickey, Signature; };
+constexpr std::array<Vector_t, 3> Knownanswers
+{{
+    { "1858cfa02a901bcf578da840b6b2abdce1cbdf18deac41d1fae156b041e68550",
+      "9511bd6843fdcd4aeca86edac712b89a851801970212bda307ca2b0662e48db8a24cd06e71730ced791e78a8a76ac93a6302df5803ed300bae51d18fd7839103" },
+    { "58a8402675b7f4adff9539b2692bc6b23a36fb97dec1ecafd1e2d91435ecfb8d",
+      "0c246070d3ff8344a6c2093daf09ff8ddf0eab5114a5891f7cb9556e2bef1cd030e3c670d2e10cb7731e2d5d754320eb2a406e372e4988ba3d448909c5bac400" },
+    { "9a406f8c98dd8c8e06d5ed0e5042199d08acbe01df5ae57a17d40f3415f1ab76",
+      "1ebd71764d1c08fbe347879362b1a4c6fb0c2ca3f484378870680e6f9e052fcb18fa8d4df287f125cdf39854c55262ed5c4af62121588d5e13d8009e05cef000" },
+}};
+
+static std::tuple<std::array<uint8_t, 32>, std::array<uint8_t, 32>> getKeypair(uint64_t n)
+{
+    std::array<uint8_t, 32> Seed{};
+    for (size_t i = 0; i < 32; ++i) Seed[i] = uint8_t(n * 31 + i * 7);
+    return Createkeypair(Seed);
+}
+static std::string_view View(const auto &Array) { return { (const char *)Array.data(), Array.size() }; }
+
+// Field elements around the edges of 2^127 - 1, and some noise.
+constexpr size_t Inputcount = 8;
+constexpr std::array<FE128_t, Inputcount> Fieldinputs = []()
+{
+    std::array<FE128_t, Inputcount> Result{};
+    uint64_t State = 0x9E3779B97F4A7C15;
+
+    for (size_t i = 0; i < 16; ++i)
+    {
+        Result[1][i] = i == 0;                          // 1
+        Result[2][i] = i == 15 ? 0x7F : 0xFF;           // p
+        Result[3][i] = i == 0 ? 0xFE : (i == 15 ? 0x7F : 0xFF); // p - 1
+        Result[4][i] = 0xFF;                            // 2^128 - 1
+    }
+    for (size_t n = 5; n < Inputcount; ++n)
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            State = State * 6364136223846793005ULL + 1442695040888963407ULL;
+            Result[n][i] = uint8_t(State >> 56);
+        }
+    }
+
+    return Result;
+}();
+
+// Constant evaluation always takes the byte-wise path.
+struct Fieldresult_t { FE128_t Sum, Difference, Product; };
+constexpr auto Fieldreference = []()
+{
+    std::array<Fieldresult_t, Inputcount * Inputcount> Result{};
+    for (size_t i = 0; i < Inputcount; ++i)
+        for (size_t j = 0; j < Inputcount; ++j)
+            Result[i * Inputcount + j] = { Fieldinputs[i] + Fieldinputs[j], Fieldinputs[i] - Fieldinputs[j], Fieldinputs[i] * Fieldinputs[j] };
+    return Result;
+}();
+constexpr auto Pointinput = FE512_t{ Fieldinputs[3], Fieldinputs[4], Fieldinputs[5], Fieldinputs[6] };
+constexpr auto Pointreference = std::array{ Square4(Pointinput), Hadamard(Pointinput), Multiply4(Pointinput, Hadamard(Pointinput)) };
+
+static bool Equal(const FE128_t &Left, const FE128_t &Right) { return std::ranges::equal(Left.Byte, Right.Byte); }
+static bool Equal(const FE512_t &Left, const FE512_t &Right) { return std::array<uint8_t, 64>(Left) == std::array<uint8_t, 64>(Right); }
+
+int main()
+{
+    // The runtime field arithmetic is bit-identical to the byte-wise reference.
+    for (size_t i = 0; i < Inputcount; ++i)
+    {
+        for (size_t j = 0; j < Inputcount; ++j)
+        {
+            const auto &Expected = Fieldreference[i * Inputcount + j];
+            auto Left = Fieldinputs[i], Right = Fieldinputs[j];
+
+            Check(Equal(Left + Right, Expected.Sum));
+            Check(Equal(Left - Right, Expected.Difference));
+            Check(Equal(Left * Right, Expected.Product));
+        }
+    }
+    {
+        auto Point = Pointinput;
+        Check(Equal(Square4(Point), Pointreference[0]));
+        Check(Equal(Hadamard(Point), Pointreference[1]));
+        Check(Equal(Multiply4(Point, Hadamard(Point)), Pointreference[2]));
+    }
+
+    // Known answers for key generation and signing, signatures are deterministic.
+    for (size_t n = 0; n < Knownanswers.size(); ++n)
+    {
+        const auto [Publickey, Privatekey] = getKeypair(n);
+        const auto Message = "Message " + std::to_string(n);
+        const auto Signature = Sign(Publickey, Privatekey, Message);
+
+        Check(Tohex(View(Publickey)) == Knownanswers[n].Publickey);
+        Check(Tohex(View(Signature)) == Knownanswers[n].Signature);
+        Check(Verify(Publickey, Signature, Message));
+    }
+
+    // Any change to the message, signature, or key fails.
+    {
+        const auto [Publickey, Privatekey] = getKeypair(0);
+        const auto [Otherkey, Unused] = getKeypair(1);
+        const auto Signature = Sign(Publickey, Privatekey, "Message 0"s);
+
+        auto Flipped = Signature; Flipped[7] ^= 1;
+        auto Flippedhigh = Signature; Flippedhigh[40] ^= 0x10;
+
+        Check(!Verify(Publickey, Signature, "Message 1"s));
+        Check(!Verify(Publickey, Flipped, "Message 0"s));
+        Check(!Verify(Publickey, Flippedhigh, "Message 0"s));
+        Check(!Verify(Otherkey, Signature, "Message 0"s));
+        Check(!Verify(Publickey, std::string(63, '\0'), "Message 0"s));
+    }
+
+    // Both sides derive the same secret.
+    {
+        std::array<uint8_t, 32> Seed1{}, Seed2{}; Seed1[0] = 1; Seed2[0] = 2;
+        const auto [Public1, Private1] = Createkeypair(Seed1);
+        const auto [Public2, Private2] = Createkeypair(Seed2);
+
+        Check(Generatesecret(Public1, Private2) == Generatesecret(Public2, Private1));
+        Check(Tohex(View(Generatesecret(Public1, Private2))) == "b95f2f0bdb976757aef024141fba10af910ae5e0b5faed0133c58290eec838cf");
+    }
+
+    // Batches agree with verifying one at a time, including duplicates and interleaved senders.
+    {
+        std::vector<std::tuple<std::array<uint8_t, 32>, std::array<uint8_t, 64>, std::string>> Signed{};
+        for (uint64_t n = 0; n < 4; ++n)
+        {
+            const auto [Publickey, Privatekey] = getKeypair(n);
+            for (size_t m = 0; m < 3; ++m)
+            {
+                const auto Message = "Batch " + std::to_string(n * 10 + m);
+                Signed.emplace_back(Publickey, Sign(Publickey, Privatekey, Message), Message);
+            }
+        }
+
+        // Tamper with a few, and repeat some (valid and not) like Merkle-batched messages would.
+        std::get<2>(Signed[2]) += "!";
+        std::get<1>(Signed[5])[3] ^= 0x80;
+        std::get<0>(Signed[9]) = std::get<0>(Signed[0]);
+        Signed.push_back(Signed[1]);
+        Signed.push_back(Signed[2]);
+        Signed.push_back(Signed[0]);
+
+        std::vector<Batchentry_t> Batch{};
+        for (const auto &[Publickey, Signature, Message] : Signed)
+            Batch.push_back({ std::span<const uint8_t, 32>(Publickey), std::span<const uint8_t, 64>(Signature), Message });
+
+        const auto Result = Verifybatch(Batch);
+        Check(Result.size() == Batch.size());
+
+        for (size_t i = 0; i < Signed.size(); ++i)
+        {
+            const auto &[Publickey, Signature, Message] = Signed[i];
+            Check(Result[i] == Verify(Publickey, Signature, Message));
+        }
+
+        Check(std::ranges::count(Result, false) == 4);
+    }
+
+    // Keys sharing a cache slot replace each other without being confused.
+    {
+        Hashmap<size_t, uint64_t> Slots{};
+        std::optional<std::pair<uint64_t, uint64_t>> Collision{};
+
+        for (uint64_t n = 100; !Collision && n < 100 + 4 * Keycache::Slotcount; ++n)
+        {
+            const auto Publickey = std::get<0>(getKeypair(n));
+            const auto Slot = Hash::WW64(Publickey.data(), Publickey.size()) % Keycache::Slotcount;
+
+            if (const auto Item = Slots.find(Slot); Item != Slots.end()) Collision = { Item->second, n };
+            else Slots.emplace(Slot, n);
+        }
+
+        Check(Collision.has_value());
+        if (Collision)
+        {
+            const auto [Public1, Private1] = getKeypair(Collision->first);
+            const auto [Public2, Private2] = getKeypair(Collision->second);
+            const auto Signature1 = Sign(Public1, Private1, "Slot"s);
+            const auto Signature2 = Sign(Public2, Private2, "Slot"s);
+
+            for (size_t Round = 0; Round < 2; ++Round)
+            {
+                Check(Verify(Public1, Signature1, "Slot"s));
+                Check(!Verify(Public2, Signature1, "Slot"s));
+                Check(Verify(Public2, Signature2, "Slot"s));
+                Check(!Verify(Public1, Signature2, "Slot"s));
+            }
+        }
+    }
+
+    return Testing::Failures;
+}
@@ -57,7 +57,7 @@ namespace AyriaAPI
     UNIQUE (Source, Target, Sent, Messagetype) )                    // Ignore duplicates.
     [&](const Base58_t &Source, const Base58_t &Target, uint32_t Messagetype, uint32_t Checksum, uint64_t Received, uint64_t Sent, const Base85_t &Message)
 
-    Group (
+    "Group" (
     GroupID TEXT PRIMARY KEY REFERENCES Account(Publickey) ON DELETE CASCADE,   // Owners ID
     Groupname TEXT,         // UTF8 escaped (\uXXXX) ASCII.
     isPublic BOOLEAN,       // Can join without an invite, unencrypted chats.
@@ -67,7 +67,7 @@ namespace AyriaAPI
 
     Groupmember (
     MemberID TEXT REFERENCES Account(Publickey) ON DELETE CASCADE,
-    GroupID TEXT REFERENCES Group(GroupID) ON DELETE CASCADE,
+    GroupID TEXT REFERENCES "Group"(GroupID) ON DELETE CASCADE,
     isModerator BOOLEAN DEFAULT false,
     UNIQUE (GroupID, MemberID) )
     [&](const Base58_t &GroupID, const Base58_t &MemberID, bool isModerator)
@@ -81,7 +81,7 @@ namespace AyriaAPI
     [&](const Base58_t &OwnerID, const ASCII_t &Category, const ASCII_t &Key, const std::optional<ASCII_t> &Value)
 
     Matchmaking (
-    GroupID TEXT PRIMARY KEY REFERENCES Group(GroupID) ON DELETE CASCADE,
+    GroupID TEXT PRIMARY KEY REFERENCES "Group"(GroupID) ON DELETE CASCADE,
     Hostaddress TEXT,   // IPAddress:Port
     Servername TEXT,    // Optional.
     Provider TEXT,      // Where to look for more info.
@@ -350,7 +350,7 @@ namespace AyriaAPI
         {
             Trycatch(
                 JSON::Object_t Result{};
-                Prepare("SELECT * FROM Groups WHERE GroupID = ?;", GroupID) >> Grouplambda
+                Prepare("SELECT * FROM \"Group\" WHERE GroupID = ?;", GroupID) >> Grouplambda
                 {
                     Result = JSON::Object_t({
                         { "Membercount", Membercount },
@@ -370,7 +370,7 @@ namespace AyriaAPI
             Trycatch(
                 Hashset<LongID_t> Groups{};
 
-                Prepare("SELECT GroupID FROM Client WHERE Groupname = ?;", Groupname) >> [&](const Base58_t &GroupID)
+                Prepare("SELECT GroupID FROM \"Group\" WHERE Groupname = ?;", Groupname) >> [&](const Base58_t &GroupID)
                 {
                     Groups.insert(GroupID);
                 };
@@ -433,9 +433,9 @@ namespace AyriaAPI
 
             auto PS = [&]()
             {
-                if (isPublic && isFull) return Prepare("SELECT GroupID FROM Group WHERE (isPublic = ? AND isFull = ?);", isPublic.value(), isFull.value());
-                if (isPublic) return Prepare("SELECT GroupID FROM Group WHERE isPublic = ?;", isPublic.value());
-                if (isFull) return Prepare("SELECT GroupID FROM Group WHERE isFull = ?;", isFull.value());
+                if (isPublic && isFull) return Prepare("SELECT GroupID FROM \"Group\" WHERE (isPublic = ? AND isFull = ?);", isPublic.value(), isFull.value());
+                if (isPublic) return Prepare("SELECT GroupID FROM \"Group\" WHERE isPublic = ?;", isPublic.value());
+                if (isFull) return Prepare("SELECT GroupID FROM \"Group\" WHERE isFull = ?;", isFull.value());
                 return Prepare(";");
             }();
 
@@ -20,9 +20,24 @@ struct Ayriamodule_t
     // Run a periodic task on the systems background thread.
     void(__cdecl *createPeriodictask)(unsigned int PeriodMS, void(__cdecl *Callback)(void));
 
-    // Call the exported JSON functions, pass NULL as name to list all. Result-string freed after 8 calls.
+    // Call the exported JSON functions, pass NULL as name to list all. Result-string freed after 16 calls on the same thread.
     const char *(__cdecl *JSONRequest)(const char *Function, const char *JSONString);
 
+    // As above, but the result-string is kept until the last JSONRelease.
+    const char *(__cdecl *JSONRequestshared)(const char *Function, const char *JSONString);
+    void(__cdecl *JSONRetain)(const char *Result);
+    void(__cdecl *JSONRelease)(const char *Result);
+
+    // Array of { "Function" : "", "Payload" : {} }, returns an array of results in the same order. Unordered requests may run concurrently.
+    const char *(__cdecl *JSONBatchrequest)(const char *JSONString, bool isOrdered);
+
+    // Runs on a backend worker, callbacks are delivered to the submitting thread when it calls JSONRuncallbacks.
+    void(__cdecl *JSONRequestAsync)(const char *Function, const char *JSONString, void(__cdecl *Callback)(const char *Result, void *Userdata), void *Userdata);
+    unsigned int(__cdecl *JSONRuncallbacks)();
+
+    // Typed calls without JSON, see the AyriaBinaryAPI.h generated by the BinaryAPI::Header command. Result valid until the next call on the thread.
+    const void *(__cdecl *BinaryRequest)(unsigned int FunctionID, const void *Arguments, unsigned int Length, unsigned int *Resultlength);
+
     // UTF8 escaped ASCII strings are used for console functions. Colour as ARGB.
     void(__cdecl *addConsolemessage)(const char *String, unsigned int Colour);
     void(__cdecl *addConsolecommand)(const char *Name, void(__cdecl *Callback)(int Argc, const char **Argv));
@@ -57,10 +72,16 @@ struct Ayriamodule_t
     {
         return doRequest(Endpoint, Payload);
     }
+    JSON::Value_t doRequests(const JSON::Array_t &Requests, bool isOrdered = true) const
+    {
+        return JSON::Parse(JSONBatchrequest(JSON::Dump(Requests).c_str(), isOrdered));
+    }
 
     // Trigger asserts instead of having to check the pointers validity.
     static const char *__cdecl AYA_Nullsub1(...) { assert(false); return ""; }
     static void __cdecl AYA_Nullsub2(...) { assert(false); }
+    static unsigned int __cdecl AYA_Nullsub3(...) { assert(false); return 0; }
+    static const void *__cdecl AYA_Nullsub4(...) { assert(false); return nullptr; }
 
     Ayriamodule_t()
     {
@@ -83,6 +104,13 @@ struct Ayriamodule_t
             Import(createPeriodictask);
             Import(onInitialized);
             Import(JSONRequest);
+            Import(JSONRequestshared);
+            Import(JSONRetain);
+            Import(JSONRelease);
+            Import(JSONBatchrequest);
+            Import(JSONRequestAsync);
+            Import(JSONRuncallbacks);
+            Import(BinaryRequest);
 
             Import(unsubscribeNotification);
             Import(subscribeNotification);
@@ -106,6 +134,13 @@ struct Ayriamodule_t
             createPeriodictask = decltype(createPeriodictask)(AYA_Nullsub2);
             onInitialized = decltype(onInitialized)(AYA_Nullsub2);
             JSONRequest = decltype(JSONRequest)(AYA_Nullsub1);
+            JSONRequestshared = decltype(JSONRequestshared)(AYA_Nullsub1);
+            JSONRetain = decltype(JSONRetain)(AYA_Nullsub2);
+            JSONRelease = decltype(JSONRelease)(AYA_Nullsub2);
+            JSONBatchrequest = decltype(JSONBatchrequest)(AYA_Nullsub1);
+            JSONRequestAsync = decltype(JSONRequestAsync)(AYA_Nullsub2);
+            JSONRuncallbacks = decltype(JSONRuncallbacks)(AYA_Nullsub3);
+            BinaryRequest = decltype(BinaryRequest)(AYA_Nullsub4);
 
             unsubscribeNotification = decltype(unsubscribeNotification)(AYA_Nullsub2);
             subscribeNotification = decltype(subscribeNotification)(AYA_Nullsub2);
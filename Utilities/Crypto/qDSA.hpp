@@ -10,36 +10,22 @@
 #pragma once
 #include <Stdinclude.hpp>
 
+// The byte-wise arithmetic is kept for constant evaluation, runtime uses 64-bit limbs where the hardware has a 64x64 -> 128 multiply.
+#if !defined(QDSA_BYTEARITHMETIC) && (defined(__SIZEOF_INT128__) || (defined(_MSC_VER) && defined(_M_X64)))
+#define QDSA_LIMB64
+#endif
+
 namespace qDSA
 {
     namespace
     {
         // 128-bit point element.
-        struct FE128_t final
+        struct alignas(16) FE128_t final
         {
-            union
-            {
-                __m128 V; // Compiler hint.
-                uint8_t Byte[128 / 8]{};
-            };
-
-            constexpr FE128_t() : Byte{} {}
-            constexpr FE128_t(const FE128_t &Input) : Byte{} { std::ranges::copy(Input.Byte, Byte); }
-            constexpr FE128_t(FE128_t &&Input) noexcept : Byte{} { std::ranges::move(Input.Byte, Byte); }
-            constexpr FE128_t(std::array<uint8_t, 128 / 8> &&Input) : Byte{} { std::ranges::move(Input, Byte); }
-            constexpr FE128_t(const std::array<uint8_t, 128 / 8> &Input) : Byte{} { std::ranges::copy(Input, Byte); }
+            uint8_t Byte[128 / 8]{};
 
-            // Just copy the bytes.
-            constexpr FE128_t &operator=(FE128_t &&Right) noexcept
-            {
-                std::ranges::move(Right.Byte, Byte);
-                return *this;
-            }
-            constexpr FE128_t &operator=(const FE128_t &Right)
-            {
-                std::ranges::copy(Right.Byte, Byte);
-                return *this;
-            }
+            constexpr FE128_t() = default;
+            constexpr FE128_t(const std::array<uint8_t, 128 / 8> &Input) { std::ranges::copy(Input, Byte); }
 
             // Simplify access to Byte.
             constexpr uint8_t &operator[](size_t i) { return Byte[i]; }
@@ -56,81 +42,68 @@ namespace qDSA
         };
 
         // 256 bit compressed Kummer point.
-        struct FE256_t final
+        // Named halves rather than a union, so that it's portable and usable in constant evaluation.
+        struct alignas(32) FE256_t final
         {
-            union
-            {
-                __m256 V; // Compiler hint.
-                uint8_t Byte[256 / 8];
-                struct { FE128_t X, Y; };
-            };
-
-            constexpr FE256_t() : Byte{} {}
-            constexpr FE256_t(const FE256_t &Input) : Byte{} { std::ranges::copy(Input.Byte, Byte); }
-            constexpr FE256_t(FE256_t &&Input) noexcept : Byte{} { std::ranges::move(Input.Byte, Byte); }
-            constexpr FE256_t(std::array<uint8_t, 256 / 8> &&Input) : Byte{} { std::ranges::move(Input, Byte); }
-            constexpr FE256_t(const std::array<uint8_t, 256 / 8> &Input) : Byte{} { std::ranges::copy(Input, Byte); }
+            FE128_t X, Y;
 
-            constexpr FE256_t(const FE128_t &A, const FE128_t &B) { X = A; Y = B; }
-            constexpr FE256_t(FE128_t &&A, FE128_t &&B) { X = std::move(A); Y = std::move(B); }
-
-            // Just copy the bytes.
-            constexpr FE256_t &operator=(FE256_t &&Right) noexcept
+            constexpr FE256_t() = default;
+            constexpr FE256_t(const FE128_t &A, const FE128_t &B) : X(A), Y(B) {}
+            constexpr FE256_t(const std::array<uint8_t, 256 / 8> &Input)
             {
-                std::ranges::move(Right.Byte, Byte);
-                return *this;
+                std::copy_n(Input.begin(), 16, X.Byte);
+                std::copy_n(Input.begin() + 16, 16, Y.Byte);
             }
-            constexpr FE256_t &operator=(const FE256_t &Right)
+
+            // Simplify access to the bytes, the halves are contiguous.
+            constexpr uint8_t &operator[](size_t i) { return i < 16 ? X.Byte[i] : Y.Byte[i - 16]; }
+            constexpr uint8_t operator[](size_t i) const { return i < 16 ? X.Byte[i] : Y.Byte[i - 16]; }
+            uint8_t *Bytes() { return reinterpret_cast<uint8_t *>(this); }
+            const uint8_t *Bytes() const { return reinterpret_cast<const uint8_t *>(this); }
+            constexpr operator std::array<uint8_t, 256 / 8>() const
             {
-                std::ranges::copy(Right.Byte, Byte);
-                return *this;
+                std::array<uint8_t, 256 / 8> Result{};
+                std::ranges::copy(X.Byte, Result.begin());
+                std::ranges::copy(Y.Byte, Result.begin() + 16);
+                return Result;
             }
-
-            // Simplify access to Byte.
-            constexpr uint8_t &operator[](size_t i) { return Byte[i]; }
-            constexpr uint8_t operator[](size_t i) const { return Byte[i]; }
-            constexpr operator std::array<uint8_t, 256 / 8>() const { return std::to_array(Byte); }
         };
 
         // 512 bit uncompressed Kummer point.
-        struct FE512_t final
+        struct alignas(64) FE512_t final
         {
-            union
-            {
-                __m512 V; // Compiler hint.
-                uint8_t Byte[512 / 8];
-                struct { FE256_t High, Low; };
-                struct { FE128_t X, Y, Z, W; };
-            };
-
-            constexpr FE512_t() : Byte{} {}
-            constexpr FE512_t(const FE512_t &Input) : Byte{} { std::ranges::copy(Input.Byte, Byte); }
-            constexpr FE512_t(FE512_t &&Input) noexcept : Byte{} { std::ranges::move(Input.Byte, Byte); }
-            constexpr FE512_t(std::array<uint8_t, 512 / 8> &&Input) : Byte{} { std::ranges::move(Input, Byte); }
-            constexpr FE512_t(const std::array<uint8_t, 512 / 8> &Input) : Byte{} { std::ranges::copy(Input, Byte); }
+            FE128_t X, Y, Z, W;
 
-            // Just copy the bytes.
-            constexpr FE512_t &operator=(FE512_t &&Right) noexcept
+            constexpr FE512_t() = default;
+            constexpr FE512_t(const FE256_t &A, const FE256_t &B) : X(A.X), Y(A.Y), Z(B.X), W(B.Y) {}
+            constexpr FE512_t(const FE128_t &A, const FE128_t &B, const FE128_t &C, const FE128_t &D) : X(A), Y(B), Z(C), W(D) {}
+            constexpr FE512_t(const std::array<uint8_t, 512 / 8> &Input)
             {
-                std::ranges::move(Right.Byte, Byte);
-                return *this;
+                std::copy_n(Input.begin(), 16, X.Byte);
+                std::copy_n(Input.begin() + 16, 16, Y.Byte);
+                std::copy_n(Input.begin() + 32, 16, Z.Byte);
+                std::copy_n(Input.begin() + 48, 16, W.Byte);
             }
-            constexpr FE512_t &operator=(const FE512_t &Right)
+
+            // High is X and Y, Low is Z and W.
+            constexpr FE256_t High() const { return { X, Y }; }
+            constexpr FE256_t Low() const { return { Z, W }; }
+            constexpr void setHigh(const FE256_t &Input) { X = Input.X; Y = Input.Y; }
+            constexpr void setLow(const FE256_t &Input) { Z = Input.X; W = Input.Y; }
+
+            // Simplify access to the bytes, the quarters are contiguous.
+            constexpr uint8_t &operator[](size_t i) { return (i < 32 ? (i < 16 ? X : Y) : (i < 48 ? Z : W)).Byte[i & 15]; }
+            constexpr uint8_t operator[](size_t i) const { return (i < 32 ? (i < 16 ? X : Y) : (i < 48 ? Z : W)).Byte[i & 15]; }
+            uint8_t *Bytes() { return reinterpret_cast<uint8_t *>(this); }
+            const uint8_t *Bytes() const { return reinterpret_cast<const uint8_t *>(this); }
+            constexpr operator std::array<uint8_t, 512 / 8>() const
             {
-                std::ranges::copy(Right.Byte, Byte);
-                return *this;
+                std::array<uint8_t, 512 / 8> Result{};
+                for (size_t i = 0; i < 64; ++i) Result[i] = (*this)[i];
+                return Result;
             }
-
-            // Simplify access to Byte.
-            constexpr uint8_t &operator[](size_t i) { return Byte[i]; }
-            constexpr uint8_t operator[](size_t i) const { return Byte[i]; }
-            constexpr operator std::array<uint8_t, 512 / 8>() const { return std::to_array(Byte); }
-
-            constexpr FE512_t(const FE256_t &A, const FE256_t &B) { High = A; Low = B; }
-            constexpr FE512_t(FE256_t &&A, FE256_t &&B) { High = std::move(A); Low = std::move(B); }
-            constexpr FE512_t(const FE128_t &A, const FE128_t &B, const FE128_t &C, const FE128_t &D) { X = A; Y = B; Z = C; W = D; }
-            constexpr FE512_t(FE128_t &&A, FE128_t &&B, FE128_t &&C, FE128_t &&D) { X = std::move(A); Y = std::move(B); Z = std::move(C); W = std::move(D); }
         };
+        static_assert(sizeof(FE256_t) == 32 && sizeof(FE512_t) == 64, "The byte views assume no padding.");
 
         // Partial addition with an offset for sets.
         constexpr FE512_t Addpartial(const FE512_t &Left, const FE256_t &Right, uint8_t Offset)
@@ -185,7 +158,7 @@ namespace qDSA
             FE512_t Result{};
             FE256_t Temp;
 
-            Result.High = Expand(X.X, Y.X);
+            Result.setHigh(Expand(X.X, Y.X));
 
             Temp = Expand(X.X, Y.Y);
             Result = Addpartial(Result, Temp, 16);
@@ -249,9 +222,9 @@ namespace qDSA
 
             for (uint8_t i = 0; i < 4; ++i)
             {
-                Temp = Expand(Buffer.Low, L6);
+                Temp = Expand(Buffer.Low(), L6);
                 for (uint8_t c = 32; c < 64; ++c) Buffer[c] = Temp[c];
-                Buffer = Addpartial(Buffer, Temp.High, 0);
+                Buffer = Addpartial(Buffer, Temp.High(), 0);
             }
 
             Buffer[33] = (Buffer[32] & 0x1c) >> 2;
@@ -259,25 +232,172 @@ namespace qDSA
             Buffer[32] |= (Buffer[31] & 0xfc) >> 2;
             Buffer[31] &= 0x03;
 
-            Temp = Expand(Buffer.Low, L1);
+            Temp = Expand(Buffer.Low(), L1);
             for (uint8_t c = 32; c < 64; ++c) Buffer[c] = Temp[c];
-            Buffer = Addpartial(Buffer, Temp.High, 0);
+            Buffer = Addpartial(Buffer, Temp.High(), 0);
 
             Buffer[33] = 0;
             Buffer[32] = (Buffer[31] & 0x04) >> 2;
             Buffer[31] &= 0x03;
 
-            Temp = Expand(Buffer.Low, L1);
+            Temp = Expand(Buffer.Low(), L1);
             Buffer[32] = 0;
-            Buffer = Addpartial(Buffer, Temp.High, 0);
+            Buffer = Addpartial(Buffer, Temp.High(), 0);
 
             for (uint8_t i = 0; i < 32; i++) { Result[i] = Buffer[i]; }
             return Result;
         }
 
+        #if defined(QDSA_LIMB64)
+        // Bit-identical to the byte-wise versions, field elements are two little-endian limbs mod 2^127 - 1.
+        namespace Limb64
+        {
+            struct Limbs_t { uint64_t Low, High; };
+
+            inline Limbs_t Load(const FE128_t &Input)
+            {
+                Limbs_t Result;
+                std::memcpy(&Result, Input.Byte, sizeof(Result));
+                return Result;
+            }
+            inline FE128_t Store(const Limbs_t &Input)
+            {
+                FE128_t Result;
+                std::memcpy(Result.Byte, &Input, sizeof(Input));
+                return Result;
+            }
+
+            inline uint64_t Addcarry(uint64_t A, uint64_t B, uint64_t &Carry)
+            {
+                const auto Sum = A + B;
+                const auto Result = Sum + Carry;
+                Carry = uint64_t(Sum < A) | uint64_t(Result < Sum);
+                return Result;
+            }
+            inline uint64_t Subborrow(uint64_t A, uint64_t B, uint64_t &Borrow)
+            {
+                const auto Difference = A - B;
+                const auto Result = Difference - Borrow;
+                Borrow = uint64_t(A < B) | uint64_t(Difference < Borrow);
+                return Result;
+            }
+            inline uint64_t Mul64(uint64_t A, uint64_t B, uint64_t &High)
+            {
+                #if defined(__SIZEOF_INT128__)
+                __extension__ const auto Product = static_cast<unsigned __int128>(A) * B;
+                High = uint64_t(Product >> 64);
+                return uint64_t(Product);
+                #else
+                return _umul128(A, B, &High);
+                #endif
+            }
+
+            // The carry out of the top limb is worth 2, as 2^128 = 2 (mod 2^127 - 1).
+            inline Limbs_t Add(const Limbs_t &Left, const Limbs_t &Right)
+            {
+                uint64_t Carry{};
+                Limbs_t Result;
+                Result.Low = Addcarry(Left.Low, Right.Low, Carry);
+                Result.High = Addcarry(Left.High, Right.High, Carry);
+
+                const auto Fold = Carry * 2; Carry = 0;
+                Result.Low = Addcarry(Result.Low, Fold, Carry);
+                Result.High = Addcarry(Result.High, 0, Carry);
+                return Result;
+            }
+            inline Limbs_t Subtract(const Limbs_t &Left, const Limbs_t &Right)
+            {
+                uint64_t Borrow{};
+                Limbs_t Result;
+                Result.Low = Subborrow(Left.Low, Right.Low, Borrow);
+                Result.High = Subborrow(Left.High, Right.High, Borrow);
+
+                const auto Fold = Borrow * 2; Borrow = 0;
+                Result.Low = Subborrow(Result.Low, Fold, Borrow);
+                Result.High = Subborrow(Result.High, 0, Borrow);
+                return Result;
+            }
+            inline Limbs_t Multiply(const Limbs_t &Left, const Limbs_t &Right)
+            {
+                uint64_t H00, H01, H10, H11;
+                const auto L00 = Mul64(Left.Low, Right.Low, H00);
+                const auto L01 = Mul64(Left.Low, Right.High, H01);
+                const auto L10 = Mul64(Left.High, Right.Low, H10);
+                const auto L11 = Mul64(Left.High, Right.High, H11);
+
+                // Full 256-bit product.
+                uint64_t Carry{};
+                const auto P0 = L00;
+                auto P1 = Addcarry(H00, L01, Carry);
+                auto P2 = Addcarry(L11, H01, Carry);
+                auto P3 = Addcarry(H11, 0, Carry);
+
+                Carry = 0;
+                P1 = Addcarry(P1, L10, Carry);
+                P2 = Addcarry(P2, H10, Carry);
+                P3 = Addcarry(P3, 0, Carry);
+
+                // Low + 2 * High, then fold what overflows 128 bits back in.
+                Carry = 0;
+                const auto S0 = Addcarry(P0, P2 << 1, Carry);
+                const auto S1 = Addcarry(P1, (P3 << 1) | (P2 >> 63), Carry);
+                const auto Fold = (Carry + (P3 >> 63)) * 2;
+
+                Carry = 0;
+                Limbs_t Result;
+                Result.Low = Addcarry(S0, Fold, Carry);
+                Result.High = Addcarry(S1, 0, Carry);
+                return Result;
+            }
+
+            // The four coordinates are independent, so the multiplies can be interleaved.
+            inline std::array<Limbs_t, 4> Load4(const FE512_t &Input)
+            {
+                std::array<Limbs_t, 4> Result;
+                std::memcpy(Result.data(), Input.Bytes(), sizeof(Result));
+                return Result;
+            }
+            inline FE512_t Store4(const std::array<Limbs_t, 4> &Input)
+            {
+                FE512_t Result;
+                std::memcpy(Result.Bytes(), Input.data(), sizeof(Input));
+                return Result;
+            }
+            inline FE512_t Multiply4(const FE512_t &Left, const FE512_t &Right)
+            {
+                auto A = Load4(Left);
+                const auto B = Load4(Right);
+
+                for (size_t i = 0; i < 4; ++i) A[i] = Multiply(A[i], B[i]);
+                return Store4(A);
+            }
+            inline FE512_t Square4(const FE512_t &Input)
+            {
+                auto A = Load4(Input);
+
+                for (size_t i = 0; i < 4; ++i) A[i] = Multiply(A[i], A[i]);
+                return Store4(A);
+            }
+            inline FE512_t Hadamard(const FE512_t &Input)
+            {
+                const auto In = Load4(Input);
+                const auto A = Subtract(In[1], In[0]);
+                const auto B = Add(In[2], In[3]);
+                const auto C = Add(In[0], In[1]);
+                const auto D = Subtract(In[2], In[3]);
+
+                return Store4({ Add(A, B), Subtract(A, B), Subtract(D, C), Add(C, D) });
+            }
+        }
+        #endif
+
         // Extracted due to needing expansion and reduction.
         constexpr FE128_t operator +(const FE128_t &Left, const FE128_t &Right)
         {
+            #if defined(QDSA_LIMB64)
+            if (!std::is_constant_evaluated()) return Limb64::Store(Limb64::Add(Limb64::Load(Left), Limb64::Load(Right)));
+            #endif
+
             FE128_t Result{};
 
             uint8_t Carry = 0;
@@ -300,6 +420,10 @@ namespace qDSA
         }
         constexpr FE128_t operator -(const FE128_t &Left, const FE128_t &Right)
         {
+            #if defined(QDSA_LIMB64)
+            if (!std::is_constant_evaluated()) return Limb64::Store(Limb64::Subtract(Limb64::Load(Left), Limb64::Load(Right)));
+            #endif
+
             FE128_t Result{};
 
             uint8_t Carry = 0;
@@ -322,6 +446,10 @@ namespace qDSA
         }
         constexpr FE128_t operator *(const FE128_t &Left, const FE128_t &Right)
         {
+            #if defined(QDSA_LIMB64)
+            if (!std::is_constant_evaluated()) return Limb64::Store(Limb64::Multiply(Limb64::Load(Left), Limb64::Load(Right)));
+            #endif
+
             return Reduce(Expand(Left, Right));
         }
 
@@ -332,11 +460,11 @@ namespace qDSA
         }
         constexpr bool isZero(const FE256_t &Input)
         {
-            return std::to_array(Input.Byte) == std::to_array(FE256_t{}.Byte);
+            return std::array<uint8_t, 256 / 8>(Input) == std::array<uint8_t, 256 / 8>{};
         }
         constexpr bool isZero(const FE512_t &Input)
         {
-            return std::to_array(Input.Byte) == std::to_array(FE512_t{}.Byte);
+            return std::array<uint8_t, 512 / 8>(Input) == std::array<uint8_t, 512 / 8>{};
         }
         constexpr FE128_t Freeze(const FE128_t &Input)
         {
@@ -452,6 +580,10 @@ namespace qDSA
         // Kummer surface helpers.
         constexpr FE512_t Square4(FE512_t Input)
         {
+            #if defined(QDSA_LIMB64)
+            if (!std::is_constant_evaluated()) return Limb64::Square4(Input);
+            #endif
+
             Input.X *= Input.X;
             Input.Y *= Input.Y;
             Input.Z *= Input.Z;
@@ -460,6 +592,10 @@ namespace qDSA
         }
         constexpr FE512_t Hadamard(const FE512_t &Input)
         {
+            #if defined(QDSA_LIMB64)
+            if (!std::is_constant_evaluated()) return Limb64::Hadamard(Input);
+            #endif
+
             const auto A = Input.Y - Input.X;
             const auto B = Input.Z + Input.W;
             const auto C = Input.X + Input.Y;
@@ -477,6 +613,10 @@ namespace qDSA
         }
         constexpr FE512_t Multiply4(FE512_t Left, const FE512_t &Right)
         {
+            #if defined(QDSA_LIMB64)
+            if (!std::is_constant_evaluated()) return Limb64::Multiply4(Left, Right);
+            #endif
+
             Left.X *= Right.X;
             Left.Y *= Right.Y;
             Left.Z *= Right.Z;
@@ -533,8 +673,8 @@ namespace qDSA
         {
             auto Temp = Expand(B, C);
 
-            Temp.High = Negate(Reduce(Temp));
-            Temp.Low = {};
+            Temp.setHigh(Negate(Reduce(Temp)));
+            Temp.setLow({});
 
             Temp = Addpartial(Temp, A, 0);
             return Reduce(Temp);
@@ -1041,49 +1181,134 @@ namespace qDSA
 
         // Share with the world..
         std::array<uint8_t, 64> Signature;
-        std::memcpy(Signature.data() + 32, W.Byte, 32);
+        std::memcpy(Signature.data() + 32, W.Bytes(), 32);
         std::memcpy(Signature.data() + 0, P.Z.Byte, 16);
         std::memcpy(Signature.data() + 16, P.W.Byte, 16);
         return Signature;
     }
 
-    template <Range_t A, Range_t B, Range_t C>
-    constexpr bool Verify(A &&Publickey, B &&Signature, C &&Message)
+    // Decompressing the public key is a fair part of verification, and we see the same senders over and over.
+    // Inline rather than in the anonymous namespace, so that there's one cache per process rather than per translation unit.
+    // Direct-mapped, a new key only replaces the one in its slot so the cache never goes cold all at once.
+    namespace Keycache
+    {
+        constexpr size_t Slotcount = 4096;
+        struct Entry_t { bool isValid; std::array<uint8_t, 32> Publickey; std::array<uint8_t, 64> Point, Wrapped; };
+        inline std::vector<Entry_t> Slots{};
+        inline std::mutex Lock{};
+    }
+
+    namespace
     {
-        const auto KP = *(FE512_t *)Signature.data();
+        struct Cachedkey_t { std::array<uint8_t, 32> Publickey; FE512_t Point, Wrapped; };
+        inline std::optional<Cachedkey_t> getCachedkey(const uint8_t *Publickey)
+        {
+            std::array<uint8_t, 32> Key;
+            std::memcpy(Key.data(), Publickey, 32);
+            const auto Slot = Hash::WW64(Key.data(), Key.size()) % Keycache::Slotcount;
 
-        // Validate compression.
-        auto P = Decompress(FE256_t{ Publickey });
-        if (isZero(P)) return false;
+            {
+                std::scoped_lock Lock(Keycache::Lock);
+                if (!Keycache::Slots.empty() && Keycache::Slots[Slot].isValid && Keycache::Slots[Slot].Publickey == Key)
+                    return Cachedkey_t{ Key, FE512_t{ Keycache::Slots[Slot].Point }, FE512_t{ Keycache::Slots[Slot].Wrapped } };
+            }
 
-        // Second point.
-        const auto Seed2 = [&]()
+            // Validate compression.
+            const auto Point = Decompress(FE256_t{ Key });
+            if (isZero(Point)) return std::nullopt;
+
+            const Cachedkey_t Entry{ Key, Point, Wrap(Point) };
+            std::scoped_lock Lock(Keycache::Lock);
+            if (Keycache::Slots.empty()) [[unlikely]] Keycache::Slots.resize(Keycache::Slotcount);
+            Keycache::Slots[Slot] = { true, Key, Entry.Point, Entry.Wrapped };
+            return Entry;
+        }
+
+        // Digest-contexts are reused per thread rather than allocated per signature.
+        inline EVP_MD_CTX *getContext()
         {
-            auto Buffer = std::make_unique<uint8_t[]>(64);
-            const auto Context = EVP_MD_CTX_create();
+            thread_local const std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> Context{ EVP_MD_CTX_new(), EVP_MD_CTX_free };
+            return Context.get();
+        }
 
-            EVP_DigestInit(Context, EVP_sha512());
-            EVP_DigestUpdate(Context, Signature.data(), Signature.size());
-            EVP_DigestUpdate(Context, Publickey.data(), Publickey.size());
+        inline bool Verifyentry(const Cachedkey_t &Key, const uint8_t *Signature, std::string_view Message)
+        {
+            FE512_t KP;
+            std::memcpy(KP.Bytes(), Signature, 64);
+
+            // Second point.
+            uint8_t Seed2[64];
+            const auto Context = getContext();
+            EVP_DigestInit_ex(Context, EVP_sha512(), nullptr);
+            // Only the R-part of the signature, as in Sign.
+            EVP_DigestUpdate(Context, Signature, 32);
+            EVP_DigestUpdate(Context, Key.Publickey.data(), 32);
             EVP_DigestUpdate(Context, Message.data(), Message.size());
-            EVP_DigestFinal(Context, Buffer.get(), {});
+            EVP_DigestFinal_ex(Context, Seed2, nullptr);
+            const auto Q = getScalar64(Seed2);
 
-            return std::move(Buffer);
-        }();
-        const auto Q = getScalar64(Seed2.get());
+            // Third point.
+            auto P = Key.Point;
+            auto W = Ladder(&P, Key.Wrapped, Q, 250);
+            P = Ladder(getScalar32(KP.Low().Bytes()), 250);
 
-        // Third point.
-        auto W = Ladder(&P, Wrap(P), Q, 250);
-        P = Ladder(getScalar32(KP.Low.Byte), 250);
+            return Check(P, W, KP.High());
+        }
+    }
+
+    // Not constexpr, the key-cache needs a lock.
+    template <Range_t A, Range_t B, Range_t C>
+    bool Verify(A &&Publickey, B &&Signature, C &&Message)
+    {
+        if (Publickey.size() != 32 || Signature.size() != 64) [[unlikely]] return false;
+
+        const auto Key = getCachedkey((const uint8_t *)Publickey.data());
+        if (!Key) return false;
+
+        return Verifyentry(*Key, (const uint8_t *)Signature.data(), { (const char *)Message.data(), Message.size() });
+    }
+
+    // Keys are decompressed once per sender, and duplicate entries (e.g. Merkle-batched messages) are only verified once.
+    struct Batchentry_t { std::span<const uint8_t, 32> Publickey; std::span<const uint8_t, 64> Signature; std::string_view Message; };
+    inline std::vector<bool> Verifybatch(std::span<const Batchentry_t> Entries)
+    {
+        std::vector<bool> Result(Entries.size());
+        Hashmap<uint64_t, size_t> Previous{};
+        std::optional<Cachedkey_t> Key{};
+
+        for (size_t i = 0; i < Entries.size(); ++i)
+        {
+            const auto &Entry = Entries[i];
+
+            const auto ID = Hash::WW64(Entry.Signature.data(), 64) ^ Hash::WW64(Entry.Message.data(), Entry.Message.size());
+            if (const auto Item = Previous.find(ID); Item != Previous.end())
+            {
+                const auto &Other = Entries[Item->second];
+                if (Other.Message == Entry.Message && std::ranges::equal(Other.Signature, Entry.Signature) && std::ranges::equal(Other.Publickey, Entry.Publickey))
+                {
+                    Result[i] = Result[Item->second];
+                    continue;
+                }
+            }
+            Previous.emplace(ID, i);
+
+            // Entries tend to be grouped by sender.
+            if (!Key || !std::ranges::equal(Key->Publickey, Entry.Publickey))
+                Key = getCachedkey(Entry.Publickey.data());
 
-        return Check(P, W, KP.High);
+            Result[i] = Key && Verifyentry(*Key, Entry.Signature.data(), Entry.Message);
+        }
+
+        return Result;
     }
 
     template <Range_t A, Range_t B>
     constexpr std::array<uint8_t, 32> Generatesecret(A &&Publickey, B &&Privatekey)
     {
         const auto Scalar = getScalar32(Privatekey.data());
-        auto PK = Decompress(*(FE256_t *)Publickey.data());
+        FE256_t Compressed;
+        std::memcpy(Compressed.Bytes(), Publickey.data(), 32);
+        auto PK = Decompress(Compressed);
         const auto PKW = Wrap(PK);
 
         auto Secret = Ladder(&PK, PKW, Scalar, 250);
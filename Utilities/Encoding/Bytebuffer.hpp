@@ -235,7 +235,9 @@ struct Bytebuffer
         // Deserialize as a blob of data.
         if constexpr (std::is_same<Type, Blob>::value)
         {
-            auto Bloblength = Read<uint32_t>(Typechecked);
+            // A truncated length must not read as an empty blob.
+            uint32_t Bloblength{};
+            if (!Read(Bloblength, Typechecked)) return false;
             Buffer.resize(Bloblength);
 
             return Rawread(Bloblength, Buffer.data());
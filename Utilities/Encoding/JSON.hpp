@@ -347,7 +347,8 @@ namespace JSON
         if (!JSONString.empty())
         {
             #if defined(HAS_SIMDJSON)
-            static simdjson::dom::parser Parser;
+            // The parser keeps internal buffers, so one per thread.
+            thread_local simdjson::dom::parser Parser;
             const std::function<Value_t(const simdjson::dom::element &)>
                 Parse = [&Parse](const simdjson::dom::element &Item) -> Value_t
             {